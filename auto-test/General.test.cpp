@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <general.enh.h>
+#include <histogram.enh.h>
 #include "test.base.h"
 
 namespace testCase
@@ -424,6 +425,32 @@ namespace testCase
 
 		ASSERT_TEST(reset, "getOrdinalIndicator test failed");
 	}
+
+	bool histogramAll()
+	{
+		enh::latency_histogram<> hist;
+		ASSERT_CONTINUE(hist.percentile(50) == 0 && hist.min() == 0, 
+			"empty histogram not zero");
+		for (unsigned long long i = 1; i <= 1000; ++i)
+			hist.record(i);
+		ASSERT_CONTINUE(hist.count() == 1000 && hist.min() == 1 && 
+			hist.max() == 1000 && hist.mean() == 500.5, "histogram summary wrong");
+		ASSERT_CONTINUE(hist.percentile(1) == 10, "small values not exact");
+		auto median = hist.percentile(50);
+		ASSERT_CONTINUE(median >= 500 && median <= 500 + 500 / 16, 
+			"median out of bounds");
+		auto tail = hist.percentile(99);
+		ASSERT_CONTINUE(tail >= 990 && tail <= 990 + 990 / 16, 
+			"tail out of bounds");
+		ASSERT_CONTINUE(hist.percentile(100) == 1000, "maximum not reported");
+		hist.record(std::chrono::microseconds(3));
+		ASSERT_CONTINUE(hist.max() == 3000, "duration not recorded in ns");
+		hist.record(~0ULL);
+		ASSERT_CONTINUE(hist.max() == ~0ULL, "largest value not recorded");
+		hist.reset();
+		ASSERT_TEST(hist.count() == 0 && hist.percentile(99) == 0, 
+			"reset failed");
+	}
 }
 
 
@@ -435,5 +462,6 @@ int main()
 	REGISTER_TEST(testCase::isConfinedAll);
 	REGISTER_TEST(testCase::signExtendAll);
 	REGISTER_TEST(testCase::ordinalAll);
+	REGISTER_TEST(testCase::histogramAll);
 	return call_main();
 }
\ No newline at end of file
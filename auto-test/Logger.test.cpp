@@ -0,0 +1,418 @@
+/** ***************************************************************************
+	\file Logger.test.cpp
+
+	\brief The file to test parts of module logger
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+	Compile with _DEBUG defined and link src/logger.cpp, log files are
+	written to the working directory. binaryTest runs log_decoder, compiled
+	from tools/log_decoder.cpp, from the working directory. environmentTest
+	runs this program again with argument environmentCheck.
+
+******************************************************************************/
+
+#ifndef _DEBUG
+#error Logger.test.cpp needs _DEBUG defined and src/logger.cpp linked
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <logger.enh.h>
+#include "test.base.h"
+
+namespace testCase
+{
+	// the number of lines in file, 0 if it does not exist
+	std::size_t countLines(const std::filesystem::path& file)
+	{
+		std::ifstream in(file);
+		std::size_t ret = 0;
+		for (std::string line; std::getline(in, line);)
+			++ret;
+		return ret;
+	}
+
+	// logs count lines from a new thread, returns the lines added to its
+	// file once flushed
+	std::size_t logFromThread(unsigned count, const std::string& function)
+	{
+		std::size_t before = 0;
+		std::size_t after = 0;
+		std::thread([&]() {
+			std::filesystem::path file = debug::getFile(std::this_thread::get_id(), function);
+			debug::flushLog();
+			before = countLines(file);
+			for (unsigned i = 0; i < count; ++i)
+				debug::Log("line " + std::to_string(i), function);
+			debug::flushLog();
+			after = countLines(file);
+			}).join();
+		return after - before;
+	}
+
+	// the last count lines of file
+	std::vector<std::string> lastLines(const std::filesystem::path& file, std::size_t count)
+	{
+		std::ifstream in(file);
+		std::vector<std::string> ret;
+		for (std::string line; std::getline(in, line);)
+			ret.push_back(line);
+		if (ret.size() > count)
+			ret.erase(ret.begin(), ret.end() - count);
+		return ret;
+	}
+
+	struct point
+	{
+		int x;
+		int y;
+	};
+
+	std::ostream& operator << (std::ostream& out, const point& value)
+	{
+		return out << "(" << value.x << ", " << value.y << ")";
+	}
+
+	// logs a value of each type debug::log_value encodes
+	void logValues()
+	{
+		bool b = true;
+		char c = 'x';
+		int i = -42;
+		long long small = -9223372036854775807LL - 1;
+		unsigned u = 42;
+		unsigned long long big = 18446744073709551615ULL;
+		float f = 0.1f;
+		double d = 3.14159265;
+		std::string s = "hello world";
+		const char* p = "pointer";
+		point pt{ 1, -2 };
+		LOG_LINE;
+		LOG_VAL(b);
+		LOG_VAL(c);
+		LOG_VAL(i);
+		LOG_VAL(small);
+		LOG_VAL(u);
+		LOG_VAL(big);
+		LOG_VAL(f);
+		LOG_VAL(d);
+		LOG_VAL(s);
+		LOG_VAL(p);
+		LOG_VAL(pt);
+		LOG_DESC("a description");
+		debug::Log("raw line", __func__);
+	}
+
+	bool binaryTest()
+	{
+		std::filesystem::path text;
+		std::filesystem::path binary;
+		std::size_t count = 0;
+		std::thread([&]() {
+			text = debug::getFile(std::this_thread::get_id(), __func__);
+			debug::flushLog();
+			count = countLines(text);
+			logValues();
+			debug::setLogFormat(debug::log_format::BINARY);
+			binary = debug::getFile(std::this_thread::get_id(), __func__);
+			logValues();
+			debug::setLogFormat(debug::log_format::TEXT);
+			debug::flushLog();
+			count = countLines(text) - count;
+			}).join();
+
+		std::filesystem::path decoded = binary.string() + ".log";
+		std::string command = "\"" + (std::filesystem::current_path() / "log_decoder").string() +
+			"\" \"" + binary.string() + "\" \"" + decoded.string() + "\"";
+#ifdef _WIN32
+		// cmd removes the outer quotes of the command
+		command = "\"" + command + "\"";
+#endif
+		ASSERT_CONTINUE(std::system(command.c_str()) == 0, "log_decoder failed");
+		ASSERT_TEST(count == 14 && lastLines(text, count) == lastLines(decoded, count),
+			"Decoded binary log differs from text log");
+	}
+
+	// the times evaluate was called
+	unsigned evaluated = 0;
+
+	int evaluate()
+	{
+		return static_cast<int>(++evaluated);
+	}
+
+	// a level 5 site logging evaluate() and a level 3 site
+	void levelSites()
+	{
+		LOG_VAL(evaluate());
+		O3_LOG_LINE;
+	}
+
+	// a level 5 site, defined at the end with a directory in its file
+	void pathSite();
+
+	// calls sites from a new thread, returns the lines added to the file of
+	// function once flushed
+	std::size_t logSites(void (*sites)(), const char* function)
+	{
+		std::size_t before = 0;
+		std::size_t after = 0;
+		std::thread([&]() {
+			std::filesystem::path file = debug::getFile(std::this_thread::get_id(), function);
+			debug::flushLog();
+			before = countLines(file);
+			sites();
+			debug::flushLog();
+			after = countLines(file);
+			}).join();
+		return after - before;
+	}
+
+	// the line of the LOG_VAL site in levelSites, 0 if not registered
+	unsigned long valueLine()
+	{
+		for (const debug::log_site* i : debug::getLogSites())
+			if (std::string(i->function) == "levelSites" && i->kind == debug::log_kind::VALUE)
+				return i->line;
+		return 0;
+	}
+
+	bool globalLevelTest()
+	{
+		unsigned previous = debug::getLogOptimisation();
+		debug::setLogOptimisation(5);
+		evaluated = 0;
+		std::size_t none = logSites(levelSites, "levelSites");
+		ASSERT_CONTINUE(none == 0 && evaluated == 0,
+			"Level 5 logged or evaluated the value");
+		debug::setLogOptimisation(3);
+		std::size_t some = logSites(levelSites, "levelSites");
+		debug::setLogOptimisation(0);
+		std::size_t all = logSites(levelSites, "levelSites");
+		debug::setLogOptimisation(previous);
+		ASSERT_TEST(some == 1 && all == 2 && evaluated == 2,
+			"Level 3 or 0 logged the wrong sites");
+	}
+
+	bool fileLevelTest()
+	{
+		unsigned previous = debug::getLogOptimisation();
+		debug::setLogOptimisation(5);
+		debug::setLogOptimisation(__FILE__, 0);
+		std::size_t enabled = logSites(levelSites, "levelSites");
+		debug::setLogOptimisation(0);
+		debug::setLogOptimisation(__FILE__, 5);
+		std::size_t disabled = logSites(levelSites, "levelSites");
+		debug::clearLogOptimisation();
+		debug::setLogOptimisation(previous);
+		ASSERT_TEST(enabled == 2 && disabled == 0,
+			"Level of the file did not override the global level");
+	}
+
+	bool lineLevelTest()
+	{
+		unsigned previous = debug::getLogOptimisation();
+		unsigned long line = valueLine();
+		ASSERT_CONTINUE(line != 0, "LOG_VAL site of levelSites not registered");
+		debug::setLogOptimisation(0);
+		debug::setLogOptimisation(__FILE__, 5);
+		debug::setLogOptimisation(__FILE__, line, 0);
+		evaluated = 0;
+		std::size_t enabled = logSites(levelSites, "levelSites");
+		debug::setLogOptimisation(__FILE__, 0);
+		debug::setLogOptimisation(__FILE__, line, 5);
+		std::size_t disabled = logSites(levelSites, "levelSites");
+		debug::clearLogOptimisation();
+		debug::setLogOptimisation(previous);
+		ASSERT_TEST(enabled == 1 && disabled == 1 && evaluated == 1,
+			"Level of the line did not override the level of the file");
+	}
+
+	bool pathLevelTest()
+	{
+		unsigned previous = debug::getLogOptimisation();
+		debug::setLogOptimisation(5);
+		debug::setLogOptimisation("pathSite.cpp", 0);
+		std::size_t component = logSites(pathSite, "pathSite");
+		debug::clearLogOptimisation();
+		debug::setLogOptimisation("Site.cpp", 0);
+		std::size_t partial = logSites(pathSite, "pathSite");
+		debug::clearLogOptimisation();
+		debug::setLogOptimisation(previous);
+		ASSERT_TEST(component == 1 && partial == 0,
+			"File not matched by its trailing path components only");
+	}
+
+	bool clearLevelTest()
+	{
+		unsigned previous = debug::getLogOptimisation();
+		debug::setLogOptimisation(0);
+		debug::setLogOptimisation(__FILE__, 5);
+		debug::setLogOptimisation(__FILE__, valueLine(), 5);
+		std::size_t overridden = logSites(levelSites, "levelSites");
+		debug::clearLogOptimisation();
+		std::size_t cleared = logSites(levelSites, "levelSites");
+		debug::setLogOptimisation(previous);
+		ASSERT_TEST(overridden == 0 && cleared == 2,
+			"clearLogOptimisation did not restore the global level");
+	}
+
+	// the line of the first of the sites of listedSites, never called
+	const unsigned long listedLine = __LINE__ + 3;
+	void listedSites()
+	{
+		LOG_LINE;
+		O2_LOG_VAL(evaluated);
+	}
+
+	bool sitesTest()
+	{
+		const debug::log_site* line = nullptr;
+		const debug::log_site* value = nullptr;
+		for (const debug::log_site* i : debug::getLogSites())
+			if (std::string(i->function) == "listedSites")
+				(i->kind == debug::log_kind::LINE ? line : value) = i;
+		ASSERT_CONTINUE(line && value, "Sites of listedSites not registered");
+		ASSERT_CONTINUE(std::string(line->file) == __FILE__ && line->line == listedLine &&
+			line->level == 5 && std::string(line->var).empty(), "LOG_LINE site differs");
+		ASSERT_TEST(std::string(value->file) == __FILE__ && value->line == listedLine + 1 &&
+			value->level == 2 && value->kind == debug::log_kind::VALUE &&
+			std::string(value->var) == "evaluated", "O2_LOG_VAL site differs");
+	}
+
+	// the path of this program, set by main
+	std::filesystem::path program;
+
+	// the level ENH_LOG_OPTIMISATION is set to for environmentCheck
+	constexpr unsigned environmentLevel = 4;
+
+	bool environmentTest()
+	{
+		std::string level = std::to_string(environmentLevel);
+#ifdef _WIN32
+		_putenv_s("ENH_LOG_OPTIMISATION", level.c_str());
+#else
+		setenv("ENH_LOG_OPTIMISATION", level.c_str(), 1);
+#endif
+		std::string command = "\"" + program.string() + "\" environmentCheck";
+#ifdef _WIN32
+		// cmd removes the outer quotes of the command
+		command = "\"" + command + "\"";
+#endif
+		int result = std::system(command.c_str());
+#ifdef _WIN32
+		_putenv_s("ENH_LOG_OPTIMISATION", "");
+#else
+		unsetenv("ENH_LOG_OPTIMISATION");
+#endif
+		ASSERT_TEST(result == 0, "ENH_LOG_OPTIMISATION not read at start");
+	}
+
+	bool blockTest()
+	{
+		debug::setLogOverflow(debug::log_overflow::BLOCK);
+		unsigned long long dropped = debug::getDroppedLogs();
+		std::size_t written = logFromThread(20000, "blockTest");
+		ASSERT_TEST(written == 20000 && debug::getDroppedLogs() == dropped,
+			"Lines lost with log_overflow::BLOCK");
+	}
+
+	bool dropTest()
+	{
+		debug::setLogOverflow(debug::log_overflow::DROP);
+		unsigned long long dropped = debug::getDroppedLogs();
+		std::size_t written = logFromThread(20000, "dropTest");
+		dropped = debug::getDroppedLogs() - dropped;
+		debug::setLogOverflow(debug::log_overflow::BLOCK);
+		ASSERT_TEST(written + dropped == 20000,
+			"Lines written and dropped do not add up");
+	}
+
+	bool flushTest()
+	{
+		std::size_t first = 0;
+		std::size_t second = 0;
+		std::thread other([&second]() { second = logFromThread(5000, "flushTestB"); });
+		first = logFromThread(5000, "flushTestA");
+		other.join();
+		ASSERT_CONTINUE(first == 5000 && second == 5000,
+			"flushLog returned before lines were written");
+		debug::flushLog();
+		ASSERT_TEST(logFromThread(0, "flushTestA") == 0, "Flush without lines failed");
+	}
+
+	// logs after the flusher is destroyed at exit, it is created after this
+	// object so is destroyed before.
+	struct shutdown_check
+	{
+		// false when this program only runs environmentCheck
+		bool active = true;
+
+		~shutdown_check()
+		{
+			if (!active)
+				return;
+			std::filesystem::path file = debug::getFile(std::this_thread::get_id(),
+				"shutdownTest");
+			std::size_t before = countLines(file);
+			debug::Log("after shutdown", "shutdownTest");
+			debug::flushLog();
+			if (!testBase::assertTest(countLines(file) == before + 1,
+				"countLines(file) == before + 1", "Line logged after shutdown lost",
+				"shutdownTest", __FILE__))
+				std::_Exit(1);
+		}
+	} shutdownCheck;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && std::string(argv[1]) == "environmentCheck")
+	{
+		testCase::shutdownCheck.active = false;
+		return debug::getLogOptimisation() == testCase::environmentLevel ? 0 : 1;
+	}
+	testCase::program = std::filesystem::absolute(argv[0]);
+	REGISTER_TEST(testCase::blockTest);
+	REGISTER_TEST(testCase::dropTest);
+	REGISTER_TEST(testCase::flushTest);
+	REGISTER_TEST(testCase::binaryTest);
+	REGISTER_TEST(testCase::globalLevelTest);
+	REGISTER_TEST(testCase::fileLevelTest);
+	REGISTER_TEST(testCase::lineLevelTest);
+	REGISTER_TEST(testCase::pathLevelTest);
+	REGISTER_TEST(testCase::clearLevelTest);
+	REGISTER_TEST(testCase::environmentTest);
+	REGISTER_TEST(testCase::sitesTest);
+	return call_main();
+}
+
+// files of sites in headers keep the directory they were included from
+#line 1 "logged/pathSite.cpp"
+void testCase::pathSite()
+{
+	LOG_LINE;
+}
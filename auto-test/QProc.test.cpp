@@ -25,7 +25,16 @@
 ******************************************************************************/
 
 #include <iostream>
+#include <vector>
 #include <queued_process.enh.h>
+#include <queued_pool.enh.h>
+#include <sharded_process.enh.h>
+#include <message_pool.enh.h>
+#include <pipeline.enh.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <stdexcept>
 #include "test.base.h"
 
 namespace testCase
@@ -114,6 +123,584 @@ namespace testCase
 
 		ASSERT_TEST(t == exp, "Restart queue failed");
 	}
+
+	bool ringBackendTest()
+	{
+		unsigned long long t = 0;
+		enh::queued_process<unsigned, enh::ring_backend<16>> tQ;
+		tQ.RegisterProc(
+			[&](unsigned a) -> enh::tristate {
+				t += a;
+				return enh::tristate::GOOD;
+			}
+		);
+		tQ.start_queue_process();
+		unsigned long long exp = 0;
+
+		std::vector<std::thread> producers;
+		for (unsigned p = 0; p < 4; ++p)
+		{
+			producers.emplace_back([&tQ]() {
+				for (unsigned i = 0; i < 1000; ++i)
+					tQ.postMessage(i);
+				});
+			for (unsigned i = 0; i < 1000; ++i)
+				exp += i;
+		}
+		for (auto& i : producers)
+			i.join();
+
+		tQ.safe_join(std::chrono::milliseconds(1));
+
+		ASSERT_TEST(t == exp, "Ring backend lost messages");
+	}
+
+	struct checked_value
+	{
+		unsigned value;
+
+		explicit checked_value(unsigned val) : value(val)
+		{
+			if (val == 0)
+				throw std::invalid_argument("zero");
+		}
+	};
+
+	bool ringThrowTest()
+	{
+		unsigned t = 0;
+		enh::queued_process<checked_value, enh::ring_backend<4>> tQ;
+		tQ.RegisterProc(
+			[&](checked_value a) -> enh::tristate {
+				t += a.value;
+				return enh::tristate::GOOD;
+			}
+		);
+		tQ.start_queue_process();
+
+		bool thrown = false;
+		try {
+			tQ.emplaceMessage(0u);
+		}
+		catch (const std::invalid_argument&)
+		{
+			thrown = true;
+		}
+		for (unsigned i = 1; i <= 10; ++i)
+			tQ.emplaceMessage(i);
+
+		tQ.safe_join(std::chrono::milliseconds(1));
+
+		ASSERT_CONTINUE(thrown, "Constructor exception not passed to caller");
+		ASSERT_TEST(t == 55, "Ring backend stalled after a throwing constructor");
+	}
+
+	bool batchTest()
+	{
+		unsigned t = 0;
+		unsigned next = 0;
+		bool ordered = true;
+		unsigned batches = 0;
+		enh::queued_process<unsigned> tQ;
+		tQ.RegisterBatchProc(
+			[&](std::vector<unsigned>& batch) -> enh::tristate {
+				++batches;
+				for (auto a : batch)
+				{
+					ordered = ordered && (a == next++);
+					t += a;
+				}
+				return enh::tristate::GOOD;
+			}
+		);
+		unsigned exp = 0;
+
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			exp += i;
+			tQ.postMessage(i);
+		}
+		tQ.start_queue_process();
+		tQ.safe_join(std::chrono::milliseconds(1));
+
+		ASSERT_CONTINUE(ordered, "Batch out of order");
+		ASSERT_CONTINUE(batches == 1, "Pending messages not drained in one batch");
+		ASSERT_TEST(t == exp, "Not evaluating all messages in batch");
+	}
+
+	bool poolTest()
+	{
+		std::atomic<unsigned> t = 0;
+		enh::queued_pool<unsigned> tQ(4);
+		tQ.RegisterProc(
+			[&](unsigned a) -> enh::tristate {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				t += a;
+				return enh::tristate::GOOD;
+			}
+		);
+		tQ.start_queue_process();
+		unsigned exp = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			exp += i;
+			tQ.postMessage(i);
+		}
+
+		tQ.safe_join(std::chrono::milliseconds(1));
+		auto elapsed = std::chrono::steady_clock::now() - start;
+
+		ASSERT_CONTINUE(t == exp, "Pool not evaluating all messages");
+		ASSERT_TEST(elapsed < std::chrono::milliseconds(8 * 20),
+			"Pool workers not running in parallel");
+	}
+
+	bool moveOnlyTest()
+	{
+		unsigned t = 0;
+		enh::queued_process<std::unique_ptr<unsigned>> tQ;
+		tQ.RegisterProc(
+			[&](std::unique_ptr<unsigned>&& a) -> enh::tristate {
+				t += *a;
+				return enh::tristate::GOOD;
+			}
+		);
+		tQ.start_queue_process();
+		unsigned exp = 0;
+
+		for (unsigned i = 0; i < 5; ++i)
+		{
+			exp += 2 * i;
+			tQ.postMessage(std::make_unique<unsigned>(i));
+			tQ.emplaceMessage(new unsigned(i));
+		}
+
+		tQ.safe_join(std::chrono::milliseconds(1));
+
+		std::string joined;
+		enh::queued_process<enh::gen_instruct<int, std::string, std::string>,
+			enh::ring_backend<4>> tR(
+				[&](enh::gen_instruct<int, std::string, std::string>&& a) -> enh::tristate {
+					joined += a.lParam + a.uParam;
+					return enh::tristate::GOOD;
+				});
+		tR.start_queue_process();
+		tR.emplaceMessage(0, "con", "cat");
+		tR.emplaceMessage(1, "ena", "te");
+		tR.safe_join(std::chrono::milliseconds(1));
+
+		ASSERT_CONTINUE(joined == "concatenate", "Emplaced aggregate not processed");
+		ASSERT_TEST(t == exp, "Move only messages not evaluated");
+	}
+
+	bool priorityTest()
+	{
+		std::vector<unsigned> order;
+		enh::queued_process<unsigned, enh::priority_backend<2, 4>> tQ;
+		tQ.RegisterProc(
+			[&](unsigned a) -> enh::tristate {
+				order.push_back(a);
+				return enh::tristate::GOOD;
+			}
+		);
+
+		for (unsigned i = 0; i < 10; ++i)
+			tQ.postMessage(100 + i);
+		for (unsigned i = 0; i < 10; ++i)
+			tQ.postMessage(i, 0);
+
+		ASSERT_CONTINUE(tQ.getLaneDepth(0) == 10 && tQ.getLaneDepth(1) == 10,
+			"Lane depth not tracked");
+
+		tQ.start_queue_process();
+		tQ.safe_join(std::chrono::milliseconds(1));
+
+		ASSERT_CONTINUE(order.size() == 20, "Not evaluating all messages");
+		ASSERT_CONTINUE(order[0] == 0 && order[3] == 3, "High priority lane not first");
+		ASSERT_TEST(order[4] == 100, "Low priority lane starved");
+	}
+
+	bool capacityTest()
+	{
+		std::vector<unsigned> got;
+		auto proc = [&](unsigned a) -> enh::tristate {
+			got.push_back(a);
+			return enh::tristate::GOOD;
+		};
+		const enh::overflow_policy policies[] = {
+			enh::overflow_policy::FAIL,
+			enh::overflow_policy::DROP_OLDEST,
+			enh::overflow_policy::DROP_NEWEST
+		};
+		const std::vector<unsigned> expected[] = {
+			{ 0, 1, 2, 3 }, { 2, 3, 4, 5 }, { 0, 1, 2, 3 }
+		};
+		for (unsigned p = 0; p < 3; ++p)
+		{
+			got.clear();
+			enh::queued_process<unsigned> tQ(proc);
+			ASSERT_CONTINUE(!!tQ.setCapacity(4, policies[p]), "Capacity not set");
+			unsigned failed = 0;
+			for (unsigned i = 0; i < 6; ++i)
+				if (!tQ.postMessage(i))
+					++failed;
+			tQ.start_queue_process();
+			tQ.safe_join(std::chrono::milliseconds(1));
+			auto stats = tQ.getOverflowStats();
+			ASSERT_CONTINUE(got == expected[p], "Wrong messages kept when full");
+			ASSERT_CONTINUE(failed == ((p == 0) ? 2 : 0), "Wrong post result when full");
+			ASSERT_CONTINUE(stats.rejected + stats.dropped_oldest 
+				+ stats.dropped_newest == 2, "Overflow not counted");
+		}
+
+		got.clear();
+		enh::queued_process<unsigned, enh::ring_backend<8>> tR(proc);
+		ASSERT_CONTINUE(!tR.setCapacity(4, enh::overflow_policy::DROP_OLDEST),
+			"Ring cannot drop oldest");
+		tR.setCapacity(2, enh::overflow_policy::BLOCK);
+		tR.postMessage(0);
+		tR.postMessage(1);
+		ASSERT_CONTINUE(!tR.tryPostMessage(2, std::chrono::milliseconds(5)),
+			"Timed post did not time out");
+		tR.start_queue_process();
+		for (unsigned i = 2; i < 100; ++i)
+			tR.postMessage(i);
+		tR.safe_join(std::chrono::milliseconds(1));
+		auto stats = tR.getOverflowStats();
+		ASSERT_CONTINUE(stats.timed_out == 1, "Time out not counted");
+		ASSERT_TEST(got.size() == 100, "Blocked posts lost");
+	}
+
+	bool inlineHandlerTest()
+	{
+		unsigned t = 0;
+		auto proc = [&t](unsigned&& a) -> enh::tristate {
+			t += a;
+			return enh::tristate::GOOD;
+		};
+		enh::inline_queued_process<unsigned, decltype(proc)> tQ(proc);
+		tQ.start_queue_process();
+		unsigned exp = 0;
+
+		for (unsigned i = 0; i < 5; ++i)
+		{
+			exp += i;
+			tQ.postMessage(i);
+		}
+
+		tQ.safe_join(std::chrono::milliseconds(1));
+
+		ASSERT_TEST(t == exp, "Inline handler not evaluating all messages");
+	}
+
+#ifdef ENH_QUEUE_STATS
+	bool statsTest()
+	{
+		enh::queued_process<unsigned> tQ([](unsigned&& a) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			return (a == 100) ? enh::tristate::ERROR : enh::tristate::GOOD;
+			});
+		for (unsigned i = 0; i < 10; ++i)
+			tQ.postMessage(i);
+		const enh::queue_stats& stats = tQ.getStats();
+		ASSERT_CONTINUE(stats.depth == 10, "Depth not counted");
+		tQ.start_queue_process();
+		tQ.safe_join(std::chrono::milliseconds(1));
+		ASSERT_CONTINUE(stats.enqueued == 10 && stats.processed == 10, 
+			"Messages not counted");
+		ASSERT_CONTINUE(stats.depth == 0 && stats.peak_depth == 10, 
+			"Depth not tracked");
+		ASSERT_CONTINUE(stats.failed == 0, "Failure miscounted");
+		ASSERT_CONTINUE(stats.wait_time.count() == 10, "Wait time not recorded");
+		ASSERT_CONTINUE(stats.handler_time.count() == 10 &&
+			stats.handler_time.min() >= 100000 && 
+			stats.handler_time.percentile(50) >= 100000,
+			"Handler time not recorded");
+
+		tQ.postMessage(100);
+		tQ.postMessage(1);
+		tQ.start_queue_process();
+		while (tQ.getStats().processed != 11)
+			std::this_thread::yield();
+		tQ.force_join();
+		ASSERT_TEST(stats.failed == 1 && stats.depth == 0, 
+			"Failure or dropped messages not counted");
+	}
+#endif
+
+	bool waitStrategyTest()
+	{
+		const enh::wait_strategy strategies[] = { enh::wait_strategy::BLOCK,
+			enh::wait_strategy::SPIN_THEN_PARK, enh::wait_strategy::BUSY_POLL };
+#ifdef ENH_QUEUE_STATS
+		unsigned long long busyParked = 1;
+#else
+		unsigned long long busyParked = 0;
+#endif
+		for (auto how : strategies)
+		{
+			unsigned long long t = 0;
+			enh::queued_process<unsigned> tQ([&t](unsigned&& a) {
+				t += a;
+				return enh::tristate::GOOD;
+				});
+			ASSERT_CONTINUE(!!tQ.setWaitStrategy(how, 64), "Strategy not set");
+			tQ.start_queue_process();
+			ASSERT_CONTINUE(!tQ.setWaitStrategy(how), 
+				"Strategy changed while running");
+			unsigned long long exp = 0;
+			for (unsigned i = 0; i < 2000; ++i)
+			{
+				exp += i;
+				tQ.postMessage(i);
+				if (i % 100 == 0)
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+			tQ.safe_join(std::chrono::milliseconds(1));
+			ASSERT_CONTINUE(t == exp, "Messages lost with wait strategy");
+#ifdef ENH_QUEUE_STATS
+			const enh::queue_stats& stats = tQ.getStats();
+			ASSERT_CONTINUE(stats.notified <= stats.parked, 
+				"Worker notified while awake");
+			if (how == enh::wait_strategy::BUSY_POLL)
+				busyParked = stats.parked;
+#endif
+		}
+		ASSERT_TEST(busyParked == 0, "Busy poll worker slept");
+	}
+
+	bool resultTest()
+	{
+		enh::queued_process<unsigned> tQ([](unsigned&& a) {
+			return (a == 3) ? enh::tristate::ERROR : enh::tristate::GOOD;
+			});
+		tQ.start_queue_process();
+		{
+			enh::post_result good = tQ.postForResult(1);
+			ASSERT_CONTINUE(good.get() == enh::tristate::GOOD, 
+				"Result of handler not returned");
+		}
+		enh::post_result bad = tQ.postForResult(3);
+		ASSERT_CONTINUE(bad.get() == enh::tristate::ERROR && bad.ready(),
+			"Error of handler not returned");
+
+		// worker exited on error, message stays queued till stopped.
+		enh::post_result left = tQ.postForResult(4);
+		ASSERT_CONTINUE(!left.wait_for(std::chrono::milliseconds(5)), 
+			"Result completed without processing");
+		tQ.force_join();
+		ASSERT_CONTINUE(left.ready() && left.get() == enh::tristate::ERROR,
+			"Destroyed message did not complete result");
+
+		tQ.setCapacity(1, enh::overflow_policy::FAIL);
+		tQ.postMessage(0);
+		enh::post_result refused = tQ.postForResult(2);
+		ASSERT_TEST(refused.ready() && refused.get() == enh::tristate::ERROR,
+			"Refused message did not complete result");
+	}
+
+	bool resultDetachTest()
+	{
+		unsigned t = 0;
+		enh::queued_process<unsigned> tQ([&t](unsigned&& a) {
+			t += a;
+			return enh::tristate::GOOD;
+			});
+		{
+			// no worker, destructor must not wait for the result.
+			enh::post_result left = tQ.postForResult(4);
+			ASSERT_CONTINUE(!left.ready(), "Result completed without worker");
+		}
+		tQ.start_queue_process();
+		enh::post_result next = tQ.postForResult(1);
+		ASSERT_CONTINUE(next.get() == enh::tristate::GOOD,
+			"Result after detached result not returned");
+		tQ.safe_join(std::chrono::milliseconds(1));
+		ASSERT_TEST(t == 5, "Message of destroyed result not processed");
+	}
+
+	bool flushTest()
+	{
+		std::atomic<unsigned> done(0);
+		enh::queued_process<unsigned> tQ([&done](unsigned&& a) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			++done;
+			return (a == 100) ? enh::tristate::ERROR : enh::tristate::GOOD;
+			});
+		tQ.postMessage(0);
+		ASSERT_CONTINUE(!tQ.flush(), "Flush succeeded without worker");
+		tQ.start_queue_process();
+		for (unsigned i = 1; i < 5; ++i)
+			tQ.postMessage(i);
+		ASSERT_CONTINUE(!!tQ.flush() && done == 5, 
+			"Flush returned before messages were processed");
+		for (unsigned i = 0; i < 5; ++i)
+			tQ.postMessage(i);
+		tQ.WaitForQueueEmpty();
+		ASSERT_CONTINUE(done == 10, 
+			"Returned before queue was empty");
+		ASSERT_CONTINUE(!!tQ.flush(), "Flush of empty queue failed");
+
+		tQ.postMessage(100);
+		tQ.postMessage(1);
+		ASSERT_CONTINUE(!tQ.flush(), "Flush succeeded after worker stopped");
+		tQ.WaitForQueueEmpty();
+		tQ.force_join();
+		ASSERT_TEST(done == 11 && !!tQ.flush(), "Flush after stop failed");
+	}
+
+	bool shardTest()
+	{
+		using info = enh::gen_instruct<unsigned, unsigned, int>;
+		constexpr unsigned shards = 4;
+		constexpr unsigned keyLimit = 1024;
+		std::vector<unsigned> next(keyLimit, 0);
+		std::atomic<unsigned> wrong(0), count(0);
+		auto key = [](const info& a) { return a.op; };
+		enh::sharded_process<info, decltype(key)> tS(key, [&](info&& a) {
+			if (a.lParam != next[a.op]++)
+				++wrong;
+			++count;
+			return enh::tristate::GOOD;
+			}, shards);
+		ASSERT_CONTINUE(tS.shardCount() == shards, "Shard count not kept");
+
+		// keys picked through shardOf so every shard gets work whatever
+		// the hash of the key.
+		std::vector<unsigned> keys;
+		unsigned perShard[shards] = {};
+		for (unsigned k = 0; k < keyLimit && keys.size() < 4 * shards; ++k)
+		{
+			unsigned shard = tS.shardOf(k);
+			ASSERT_CONTINUE(shard < shards, "Key mapped outside shards");
+			if (perShard[shard] < 4)
+			{
+				++perShard[shard];
+				keys.push_back(k);
+			}
+		}
+		ASSERT_CONTINUE(keys.size() == 4 * shards, "Keys of some shard not found");
+
+		for (unsigned i = 0; i < 50; ++i)
+			for (unsigned k : keys)
+				tS.postMessage(info{ k, i, 0 });
+		bool routed = true;
+		for (unsigned i = 0; i < tS.shardCount(); ++i)
+			routed = routed && tS.getShardDepth(i) == 50 * perShard[i];
+		ASSERT_CONTINUE(routed, "Messages not queued on shard of key");
+		ASSERT_CONTINUE(tS.shardOf(3) == tS.shardOf(3), "Key moved shard");
+		tS.start_queue_process();
+		ASSERT_CONTINUE(tS.postForResult(info{ keys[0], 50, 0 }).get() == 
+			enh::tristate::GOOD, "Result not returned from shard");
+		ASSERT_CONTINUE(!!tS.flush(), "Flush failed");
+		tS.safe_join();
+		ASSERT_TEST(wrong == 0 && count == 50 * keys.size() + 1, 
+			"Order per key not kept");
+	}
+
+	bool messagePoolTest()
+	{
+		using info = enh::gen_instruct<unsigned, enh::pooled<std::string>, int>;
+		enh::message_pool<std::string> pool;
+		std::atomic<unsigned> wrong(0);
+		enh::queued_process<info> tQ([&wrong](info&& a) {
+			if (*a.lParam != std::string(100, char('a' + a.op % 26)))
+				++wrong;
+			return enh::tristate::GOOD;
+			});
+		tQ.start_queue_process();
+		const std::string* first = nullptr;
+		for (unsigned i = 0; i < 20; ++i)
+		{
+			enh::pooled<std::string> text = pool.acquire();
+			ASSERT_CONTINUE(text->empty(), "Recycled payload not cleared");
+			if (!first)
+				first = text.get();
+			text->assign(100, char('a' + i % 26));
+			tQ.postMessage(info{ i, std::move(text), 0 });
+			tQ.flush();
+		}
+		ASSERT_CONTINUE(pool.allocated() == 1 && pool.acquire().get() == first,
+			"Payload not recycled");
+		for (unsigned i = 0; i < 200; ++i)
+		{
+			enh::pooled<std::string> text = pool.acquire();
+			text->assign(100, char('a' + i % 26));
+			tQ.postMessage(info{ i, std::move(text), 0 });
+		}
+		tQ.safe_join();
+		ASSERT_TEST(wrong == 0 && pool.allocated() <= 200, 
+			"Pooled messages corrupted");
+	}
+
+	bool pipelineTest()
+	{
+		std::atomic<unsigned long long> sum(0);
+		std::atomic<unsigned> count(0);
+		auto line = enh::pipeline_builder<std::string>()
+			.stage([](std::string&& text) { return unsigned(std::stoul(text)); })
+			.stage([](unsigned&& value) -> std::optional<unsigned long long> {
+				if (value % 10 == 0)
+					return std::nullopt;
+				return value * 2ULL;
+				}, 3, 16)
+			.stage([](unsigned long long&& value) { return value; }, 1, 4)
+			.sink([&](unsigned long long&& value) {
+				sum += value;
+				++count;
+				return enh::tristate::GOOD;
+				}, 2);
+		ASSERT_CONTINUE(line.stageCount() == 4 && line.getStageWorkers(1) == 3,
+			"Stages not built");
+		ASSERT_CONTINUE(!line.post("1"), "Posted before start");
+		ASSERT_CONTINUE(!!line.start() && !line.start(), "Start failed");
+		unsigned long long expected = 0;
+		for (unsigned i = 1; i <= 1000; ++i)
+		{
+			line.post(std::to_string(i));
+			if (i % 10)
+				expected += i * 2ULL;
+		}
+		line.finish();
+		ASSERT_CONTINUE(!line.isPipelineRunning() && !line.post("1"),
+			"Posted after finish");
+		ASSERT_CONTINUE(line.getStageStats(0).processed == 1000 &&
+			line.getStageStats(1).filtered == 100 &&
+			line.getStageStats(3).processed == 900 &&
+			line.getStageStats(3).latency.count() == 900 &&
+			line.getStageStats(3).latency.min() >= 
+			line.getStageStats(0).latency.min(),
+			"Stage statistics wrong");
+
+		std::atomic<unsigned> seen(0);
+		std::atomic<bool> release(false);
+		{
+			auto blocked = enh::pipeline_builder<unsigned>()
+				.sink([&](unsigned&&) {
+					++seen;
+					while (!release.load())
+						std::this_thread::yield();
+					return enh::tristate::GOOD;
+					}, 1, 2);
+			blocked.start();
+			for (unsigned i = 0; i < 3; ++i)
+				blocked.post(i);
+			std::thread poster([&blocked]() { blocked.post(3); });
+			while (seen.load() == 0)
+				std::this_thread::yield();
+			std::thread releaser([&release]() {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				release = true;
+				});
+			blocked.force_stop();
+			poster.join();
+			releaser.join();
+		}
+		ASSERT_TEST(count == 900 && sum == expected && seen <= 4,
+			"Pipeline failed");
+	}
 }
 
 int main()
@@ -121,5 +708,23 @@ int main()
 	REGISTER_TEST(testCase::basicTest);
 	REGISTER_TEST(testCase::forceStopTest);
 	REGISTER_TEST(testCase::restartTest);
+	REGISTER_TEST(testCase::ringBackendTest);
+	REGISTER_TEST(testCase::ringThrowTest);
+	REGISTER_TEST(testCase::batchTest);
+	REGISTER_TEST(testCase::poolTest);
+	REGISTER_TEST(testCase::moveOnlyTest);
+	REGISTER_TEST(testCase::priorityTest);
+	REGISTER_TEST(testCase::capacityTest);
+	REGISTER_TEST(testCase::inlineHandlerTest);
+#ifdef ENH_QUEUE_STATS
+	REGISTER_TEST(testCase::statsTest);
+#endif
+	REGISTER_TEST(testCase::waitStrategyTest);
+	REGISTER_TEST(testCase::resultTest);
+	REGISTER_TEST(testCase::resultDetachTest);
+	REGISTER_TEST(testCase::flushTest);
+	REGISTER_TEST(testCase::shardTest);
+	REGISTER_TEST(testCase::messagePoolTest);
+	REGISTER_TEST(testCase::pipelineTest);
 	return call_main();
 }
\ No newline at end of file
@@ -26,7 +26,9 @@
 
 #include <iostream>
 #include <timer.enh.h>
+#include <timer_wheel.enh.h>
 #include <atomic>
+#include <vector>
 #include "test.base.h"
 
 namespace testCase
@@ -87,6 +89,181 @@ namespace testCase
 		ASSERT_TEST(elapsed > expected, "Timer does not restart");
 	}
 
+
+	bool CallbackTest()
+	{
+		enh::millis<5> timerObject;
+		std::atomic<unsigned> every(0), third(0), calls(0), wrong(0);
+		std::atomic<unsigned long long> last(0);
+		auto each = timerObject.addCallback([&](unsigned long long cycle) {
+			if (cycle != last + 1)
+				++wrong;
+			last = cycle;
+			++every;
+			});
+		timerObject.addCallback([&](unsigned long long cycle) {
+			if (cycle % 3)
+				++wrong;
+			++third;
+			}, 3);
+		auto stall = timerObject.addCallback([&](unsigned long long) {
+			if (++calls == 10)
+				std::this_thread::sleep_for(std::chrono::milliseconds(30));
+			});
+		timerObject.wait_for(40);
+		ASSERT_CONTINUE(timerObject.removeCallback(each) &&
+			!timerObject.removeCallback(each), "Callback not removed");
+		unsigned long long elapsed = timerObject.elapsed();
+		ASSERT_CONTINUE(wrong == 0 && every >= 35 && third >= elapsed / 3 - 2 &&
+			timerObject.getOverrunCount() > 0 &&
+			timerObject.getSkippedCycles() == 0, "Catch up failed");
+
+		timerObject.force_join();
+		timerObject.removeCallback(stall);
+		calls = 0;
+		last = 0;
+		std::atomic<unsigned long long> jumps(0);
+		timerObject.addCallback([&](unsigned long long cycle) {
+			if (cycle > last + 1)
+				++jumps;
+			last = cycle;
+			if (++calls == 10)
+				std::this_thread::sleep_for(std::chrono::milliseconds(30));
+			});
+		timerObject.setOverrunPolicy(enh::overrun_policy::SKIP);
+		timerObject.start_timer();
+		timerObject.wait_for(40);
+		ASSERT_TEST(timerObject.getSkippedCycles() >= 4 && jumps > 0 &&
+			calls < timerObject.elapsed(), "Skip failed");
+	}
+
+	bool JitterTest()
+	{
+		enh::millis<5> timerObject;
+		timerObject.wait_for(20);
+		const auto& jitter = timerObject.getJitter();
+		ASSERT_CONTINUE(jitter.count() >= 19 && jitter.count() <= timerObject.elapsed()
+			&& jitter.min() <= jitter.percentile(50) &&
+			jitter.percentile(50) <= jitter.percentile(99) &&
+			jitter.percentile(99) <= jitter.max(), "Jitter not recorded");
+		timerObject.force_join();
+		timerObject.start_timer();
+		ASSERT_TEST(timerObject.getJitter().count() <= 1, "Jitter not reset");
+	}
+
+	bool PreciseTest()
+	{
+		enh::precise_micros<200> timerObject;
+		auto start = enh::high_res::now();
+		timerObject.wait_for(500);
+		auto end = enh::high_res::now();
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+		ASSERT_CONTINUE(elapsed >= 499 * 200 && timerObject.getJitter().count() >= 499,
+			"Precise timer does not wait for given time");
+		timerObject.setSpinBudget(std::chrono::microseconds(0));
+		timerObject.wait_for(10);
+		ASSERT_TEST(timerObject.elapsed() >= 510, "Precise timer failed");
+	}
+
+	bool SnapshotTest()
+	{
+		enh::millis<5> timerObject;
+		std::atomic<bool> stop(false);
+		std::atomic<unsigned> wrong(0);
+		std::thread reader([&]() {
+			enh::timer_snapshot last = timerObject.snapshot();
+			while (!stop.load())
+			{
+				enh::timer_snapshot now = timerObject.snapshot();
+				if (now.cycle < last.cycle || (now.cycle > last.cycle) != (now.time > last.time)
+					|| now.cycle > timerObject.elapsed())
+					++wrong;
+				last = now;
+			}
+			});
+		timerObject.wait_for(20);
+		stop = true;
+		reader.join();
+		enh::timer_snapshot snap = timerObject.snapshot();
+		ASSERT_TEST(wrong == 0 && snap.cycle >= 20 && snap.cycle <= timerObject.elapsed() &&
+			snap.time <= enh::high_res::now(), "Snapshot inconsistent");
+	}
+
+	bool WaiterTest()
+	{
+		enh::millis<5> timerObject;
+		std::atomic<unsigned> early(0);
+		std::vector<std::thread> clients;
+		for (unsigned i = 0; i < 20; ++i)
+			clients.emplace_back([&, i]() {
+				unsigned long long target = timerObject.elapsed() + 1 + i % 7;
+				timerObject.wait(target);
+				if (timerObject.elapsed() < target)
+					++early;
+				for (unsigned j = 0; j < 3; ++j)
+					timerObject.wait();
+				});
+		for (auto& i : clients)
+			i.join();
+		ASSERT_TEST(early == 0, "Waiter woken before its cycle");
+	}
+
+	bool WheelTest()
+	{
+		enh::timer_wheel<1> wheel;
+		std::atomic<unsigned> fired(0), wrong(0), periodic(0);
+		std::vector<enh::timer_wheel<1>::timer_id> ids;
+		for (unsigned i = 0; i < 2000; ++i)
+		{
+			unsigned long long delay = i % 300;
+			ids.push_back(wheel.schedule_after(delay, [&, delay]() {
+				if (wheel.elapsed() <= delay)
+					++wrong;
+				++fired;
+				}));
+		}
+		for (unsigned i = 0; i < 2000; i += 2)
+			ASSERT_CONTINUE(wheel.cancel(ids[i]), "Cancel failed");
+		ASSERT_CONTINUE(!wheel.cancel(ids[0]) && !wheel.cancel(0),
+			"Stale id cancelled");
+		auto far = wheel.schedule_after(std::chrono::hours(24 * 365), []() {});
+		enh::timer_wheel<1>::timer_id self = 0;
+		self = wheel.schedule_every(std::chrono::milliseconds(20), [&]() {
+			if (++periodic == 5)
+				wheel.cancel(self);
+			});
+		ASSERT_CONTINUE(wheel.pending() == 1002, "Timers not scheduled");
+		ASSERT_CONTINUE(wheel.start() && !wheel.start(), "Wheel not started");
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		wheel.force_join();
+		ASSERT_CONTINUE(wheel.cancel(far), "Far timer lost");
+		ASSERT_TEST(fired == 1000 && wrong == 0 && periodic == 5 &&
+			wheel.pending() == 0, "Timer wheel failed");
+	}
+
+	bool WheelCancelTest()
+	{
+		enh::timer_wheel<1> wheel;
+		std::atomic<unsigned> fired(0), cancelled(0);
+		enh::timer_wheel<1>::timer_id first = 0, second = 0;
+		// both in the same slot, whichever is called first cancels the other.
+		first = wheel.schedule_after(10, [&]() {
+			++fired;
+			if (wheel.cancel(second))
+				++cancelled;
+			});
+		second = wheel.schedule_after(10, [&]() {
+			++fired;
+			if (wheel.cancel(first))
+				++cancelled;
+			});
+		ASSERT_CONTINUE(wheel.start(), "Wheel not started");
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		wheel.force_join();
+		ASSERT_TEST(fired == 1 && cancelled == 1 && wheel.pending() == 0,
+			"Timer cancelled in same tick was called");
+	}
+
 }
 
 int main()
@@ -94,5 +271,12 @@ int main()
 	REGISTER_TEST(testCase::BasicTest);
 	REGISTER_TEST(testCase::InterruptTest);
 	REGISTER_TEST(testCase::RestartTest);
+	REGISTER_TEST(testCase::CallbackTest);
+	REGISTER_TEST(testCase::JitterTest);
+	REGISTER_TEST(testCase::PreciseTest);
+	REGISTER_TEST(testCase::SnapshotTest);
+	REGISTER_TEST(testCase::WaiterTest);
+	REGISTER_TEST(testCase::WheelTest);
+	REGISTER_TEST(testCase::WheelCancelTest);
 	return call_main();
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <pipeline.enh.h>
+#include <iostream>
+#include <string>
+#include <atomic>
+
+std::atomic<unsigned long long> total = 0;
+
+int main()
+{
+	auto line = enh::pipeline_builder<std::string>()
+		.stage([](std::string&& text) { return std::stoul(text); })
+		.stage([](unsigned long&& value) -> std::optional<unsigned long> {
+			// drop multiples of 3.
+			if (value % 3 == 0)
+				return std::nullopt;
+			return value * value;
+			}, 2)
+		.sink([](unsigned long&& value) {
+			total += value;
+			return enh::tristate::GOOD;
+			});
+	line.start();
+	for (unsigned i = 1; i <= 10; ++i)
+		line.post(std::to_string(i));
+	line.finish();
+	std::cout << total << "\n";
+	std::cout << line.getStageStats(1).processed << " "
+		<< line.getStageStats(1).filtered << "\n";
+	return 0;
+}
+
+/* ****************************************************************************
+
+Output:
+259
+10 3
+
+******************************************************************************/
@@ -0,0 +1,30 @@
+#include <queued_pool.enh.h>
+#include <iostream>
+#include <atomic>
+
+std::atomic<unsigned long long> total = 0;
+
+enh::tristate process(unsigned value)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	total += value;
+	return enh::tristate::GOOD;
+}
+
+int main()
+{
+	enh::queued_pool<unsigned> pool(process, 4);
+	pool.start_queue_process();
+	for (unsigned i = 1; i <= 100; ++i)
+		pool.postMessage(i);
+	pool.safe_join(std::chrono::milliseconds(1));
+	std::cout << total << "\n";
+	return 0;
+}
+
+/* ****************************************************************************
+
+Output:
+5050
+
+******************************************************************************/
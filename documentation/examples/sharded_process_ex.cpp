@@ -0,0 +1,36 @@
+#include <sharded_process.enh.h>
+#include <iostream>
+#include <atomic>
+
+using info = enh::gen_instruct<unsigned, unsigned, int>;
+
+unsigned next_step[8] = {};
+std::atomic<unsigned> out_of_order = 0;
+
+enh::tristate process(info&& value)
+{
+	// only the worker of this session's shard touches next_step[session].
+	if (value.lParam != next_step[value.op]++)
+		++out_of_order;
+	return enh::tristate::GOOD;
+}
+
+int main()
+{
+	auto session = [](const info& value) { return value.op; };
+	enh::sharded_process<info, decltype(session)> sharded(session, process, 4);
+	sharded.start_queue_process();
+	for (unsigned step = 0; step < 100; ++step)
+		for (unsigned s = 0; s < 8; ++s)
+			sharded.postMessage(info{ s, step, 0 });
+	sharded.safe_join();
+	std::cout << out_of_order << "\n";
+	return 0;
+}
+
+/* ****************************************************************************
+
+Output:
+0
+
+******************************************************************************/
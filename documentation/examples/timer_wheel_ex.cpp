@@ -0,0 +1,35 @@
+#include <timer_wheel.enh.h>
+#include <iostream>
+#include <atomic>
+#include <vector>
+
+int main()
+{
+	enh::timer_wheel<1> wheel;
+	std::atomic<unsigned> expired = 0;
+	std::atomic<unsigned> beats = 0;
+
+	// a keepalive for each of 10000 connections, the odd ones reply in time.
+	std::vector<enh::timer_wheel<1>::timer_id> keepalive;
+	for (unsigned i = 0; i < 10000; ++i)
+		keepalive.push_back(wheel.schedule_after(std::chrono::milliseconds(100 + i % 50),
+			[&expired]() { ++expired; }));
+	for (unsigned i = 1; i < 10000; i += 2)
+		wheel.cancel(keepalive[i]);
+
+	auto beat = wheel.schedule_every(std::chrono::milliseconds(30), [&beats]() { ++beats; });
+	wheel.start();
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	wheel.cancel(beat);
+	wheel.force_join();
+
+	std::cout << expired << " " << (beats >= 5) << " " << wheel.pending() << "\n";
+	return 0;
+}
+
+/* ****************************************************************************
+
+Output:
+5000 1 0
+
+******************************************************************************/
@@ -0,0 +1,301 @@
+/** ***************************************************************************
+	\file histogram.enh.h
+
+	\brief The file to declare class latency_histogram
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+******************************************************************************/
+
+#ifndef HISTOGRAM_ENH_H
+
+#define HISTOGRAM_ENH_H						histogram.enh.h
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <limits>
+
+namespace enh
+{
+
+	/**
+		\brief The class to record the distribution of durations or other
+		unsigned values with bounded relative error.
+
+
+		hasErrorHandlers        = false;\n
+
+		Values below 2^sub_bits are counted exactly, larger values are
+		counted in 2^sub_bits buckets per power of 2, so the relative error of
+		a reported percentile is less than 2^-sub_bits (6.25 % by default).
+
+		Every counter is atomic, values can be recorded from any number of
+		threads and read from others without locking. Readings taken while
+		values are recorded may not include all of them.
+
+		<h3>Template arguments</h3>
+		-#  <code>unsigned sub_bits</code> : The number of bits of precision
+		kept for each value.\n
+
+		<h3> How To Use </h3>
+
+		- Call `record` with the value or a std::chrono::duration (recorded
+		in nanoseconds).
+
+		- Call `percentile`, `mean`, `min`, `max` and `count` to read.
+
+	*/
+	template<unsigned sub_bits = 4>
+	class latency_histogram
+	{
+	public:
+
+		static_assert(sub_bits >= 1 && sub_bits < 16, "sub_bits must be within [1,15]");
+
+		/**
+			\brief The type of value recorded.
+		*/
+		using value_type = unsigned long long;
+
+		/**
+			\brief The number of buckets per power of 2.
+		*/
+		static constexpr unsigned sub_count = 1U << sub_bits;
+
+		/**
+			\brief The total number of buckets.
+		*/
+		static constexpr unsigned bucket_count = (64 - sub_bits + 1) * sub_count;
+
+	private:
+
+		/**
+			\brief The number of values in each bucket.
+		*/
+		std::array<std::atomic<unsigned long long>, bucket_count> buckets;
+
+		/**
+			\brief The number of values recorded.
+		*/
+		std::atomic<unsigned long long> total;
+
+		/**
+			\brief The sum of values recorded.
+		*/
+		std::atomic<unsigned long long> sum;
+
+		/**
+			\brief The smallest value recorded.
+		*/
+		std::atomic<value_type> minimum;
+
+		/**
+			\brief The largest value recorded.
+		*/
+		std::atomic<value_type> maximum;
+
+		/**
+			\brief The position of the highest bit set, value must not be 0.
+		*/
+		static constexpr unsigned magnitude(
+			value_type value /**< : <i>in</i> : The value.*/
+		) noexcept
+		{
+			unsigned ret = 0;
+			for (unsigned shift = 32; shift > 0; shift /= 2)
+			{
+				if (value >> shift)
+				{
+					value >>= shift;
+					ret += shift;
+				}
+			}
+			return ret;
+		}
+
+		/**
+			\brief The bucket a value is counted in.
+		*/
+		static constexpr unsigned index(
+			value_type value /**< : <i>in</i> : The value.*/
+		) noexcept
+		{
+			if (value < sub_count)
+				return static_cast<unsigned>(value);
+			unsigned shift = magnitude(value) - sub_bits;
+			return (shift + 1) * sub_count +
+				static_cast<unsigned>((value >> shift) - sub_count);
+		}
+
+		/**
+			\brief The largest value counted in a bucket.
+		*/
+		static constexpr value_type upper_bound(
+			unsigned bucket /**< : <i>in</i> : The bucket.*/
+		) noexcept
+		{
+			if (bucket < sub_count)
+				return bucket;
+			unsigned shift = bucket / sub_count - 1;
+			value_type lower = static_cast<value_type>(sub_count +
+				bucket % sub_count) << shift;
+			return lower + ((value_type(1) << shift) - 1);
+		}
+
+	public:
+
+		/**
+			\brief Constructs an empty histogram.
+		*/
+		latency_histogram() noexcept
+		{
+			reset();
+		}
+
+		latency_histogram(const latency_histogram&) = delete;
+
+		latency_histogram& operator = (const latency_histogram&) = delete;
+
+		/**
+			\brief Removes all values recorded, must not be called while values
+			are recorded.
+		*/
+		void reset() noexcept
+		{
+			for (auto& i : buckets)
+				i.store(0, std::memory_order_relaxed);
+			total.store(0, std::memory_order_relaxed);
+			sum.store(0, std::memory_order_relaxed);
+			minimum.store(std::numeric_limits<value_type>::max(),
+				std::memory_order_relaxed);
+			maximum.store(0, std::memory_order_relaxed);
+		}
+
+		/**
+			\brief Records a value.
+		*/
+		void record(
+			value_type value /**< : <i>in</i> : The value.*/
+		) noexcept
+		{
+			buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+			total.fetch_add(1, std::memory_order_relaxed);
+			sum.fetch_add(value, std::memory_order_relaxed);
+			value_type current = minimum.load(std::memory_order_relaxed);
+			while (value < current && !minimum.compare_exchange_weak(current,
+				value, std::memory_order_relaxed))
+				;
+			current = maximum.load(std::memory_order_relaxed);
+			while (value > current && !maximum.compare_exchange_weak(current,
+				value, std::memory_order_relaxed))
+				;
+		}
+
+		/**
+			\brief Records a duration in nanoseconds, negative durations are
+			recorded as 0.
+		*/
+		template<class Rep, class Period>
+		inline void record(
+			std::chrono::duration<Rep, Period> value /**< : <i>in</i> : The
+							duration.*/
+		) noexcept
+		{
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(value).count();
+			record(static_cast<value_type>(ns > 0 ? ns : 0));
+		}
+
+		/**
+			\brief The number of values recorded.
+		*/
+		inline unsigned long long count() const noexcept
+		{
+			return total.load(std::memory_order_relaxed);
+		}
+
+		/**
+			\brief The smallest value recorded, 0 if empty.
+		*/
+		inline value_type min() const noexcept
+		{
+			return count() ? minimum.load(std::memory_order_relaxed) : 0;
+		}
+
+		/**
+			\brief The largest value recorded.
+		*/
+		inline value_type max() const noexcept
+		{
+			return maximum.load(std::memory_order_relaxed);
+		}
+
+		/**
+			\brief The mean of values recorded, 0 if empty.
+		*/
+		inline double mean() const noexcept
+		{
+			unsigned long long n = count();
+			return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n
+				: 0.0;
+		}
+
+		/**
+			\brief The value below or at which the percentage of values passed
+			lie, reported as the upper bound of its bucket.
+
+			<h3>Return</h3>
+			The percentile, 0 if empty.\n
+		*/
+		value_type percentile(
+			double percent /**< : <i>in</i> : The percentage in [0,100].*/
+		) const noexcept
+		{
+			unsigned long long n = 0;
+			for (auto& i : buckets)
+				n += i.load(std::memory_order_relaxed);
+			if (n == 0)
+				return 0;
+			if (percent < 0)
+				percent = 0;
+			if (percent > 100)
+				percent = 100;
+			unsigned long long target = static_cast<unsigned long long>(
+				percent / 100.0 * static_cast<double>(n) + 0.5);
+			if (target == 0)
+				target = 1;
+			unsigned long long seen = 0;
+			for (unsigned i = 0; i < bucket_count; ++i)
+			{
+				seen += buckets[i].load(std::memory_order_relaxed);
+				if (seen >= target)
+				{
+					value_type bound = upper_bound(i);
+					value_type largest = max();
+					return (bound < largest) ? bound : largest;
+				}
+			}
+			return max();
+		}
+	};
+
+}
+
+#endif
@@ -29,7 +29,8 @@
 	- Make sure to add `logger.cpp` to compilation
 
 	- Use the macros `O#_LOG_LINE, O#_LOG_DESC, O#_LOG_VAL where # in [1,5]` in
-	code at specific logging points.
+	code at specific logging points. Each use is a constant debug::log_site,
+	the call passes only its address. `debug::getLogSites` lists them.
 		- `O#_LOG_LINE where # in [1,5]` takes no arguments and logs the 
 	completion of that line in that function.
 		- `O#_LOG_DESC where # in [1,5]` takes one argument that is a string
@@ -45,6 +46,11 @@
 	optimisation 0, all logging O5, O4, O3, O2, O1 is active but for 
 	optimisation 5 none is active.
 
+	- Call `debug::setLogOptimisation` to raise the optimisation at runtime,
+	for all files, a file or a line. Set environment variable
+	`ENH_LOG_OPTIMISATION` for the level at start. Logging removed by
+	`ENH_OPTIMISATION` stays removed.
+
 	- Define `ENH_CLEAR_OP__` to use no logging (automatic if `_DEBUG` is not
 	defined).
 
@@ -60,6 +66,17 @@
 	- Use `REPLACE_AS` for expression with different values during debug and
 	release.
 
+	- Lines are buffered per thread and written by a background thread
+	that keeps the files open, at most 10 ms later. Call `debug::flushLog`
+	to wait till they are written, `debug::setLogOverflow` to drop lines
+	instead of waiting when a buffer is full. Define `ENH_LOG_SYNC` when
+	compiling `logger.cpp` to write each line at once instead.
+
+	- Call `debug::setLogFormat(debug::log_format::BINARY)` before the first
+	log to write compact binary `.blog` files instead of text. Values are
+	stored typed, file and function names once per file. Render them in the
+	text layout with `tools/log_decoder.cpp`.
+
 	<h4> Examples </h4>
 	
 	Debug active :
@@ -82,6 +99,12 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <string_view>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <atomic>
 
 
 
@@ -119,10 +142,170 @@
 namespace debug
 {
 
+	/**
+		\brief The enumeration of what a thread logging does when its buffer
+		is full.
+	*/
+	enum class log_overflow
+	{
+		BLOCK,	/**< \brief Wait till the flusher makes space.*/
+		DROP	/**< \brief Drop the line and count it.*/
+	};
+
+	/**
+		\brief Sets what a thread logging does when its buffer is full,
+		default is log_overflow::BLOCK.
+	*/
+	void setLogOverflow(
+		log_overflow how /**< : <i>in</i> : The policy.*/
+	);
+
+	/**
+		\brief The number of lines dropped by log_overflow::DROP.
+	*/
+	unsigned long long getDroppedLogs();
+
+	/**
+		\brief Blocks till all lines logged before the call are written to
+		their files.
+	*/
+	void flushLog();
+
+	/**
+		\brief The enumeration of formats of log files.
+	*/
+	enum class log_format
+	{
+		TEXT,	/**< \brief Formatted lines, `.log` files.*/
+		BINARY	/**< \brief Encoded records, `.blog` files.*/
+	};
+
+	/**
+		\brief Sets the format of log files, default is log_format::TEXT.
+
+		Should be called before the first log, a thread keeps the file it
+		opened for a format.
+	*/
+	void setLogFormat(
+		log_format how /**< : <i>in</i> : The format.*/
+	);
+
+	/**
+		\brief The format of log files.
+	*/
+	log_format getLogFormat();
+
+	/**
+		\brief Appends value to out as LEB128, 7 bits per byte, lowest
+		first.
+	*/
+	inline void appendVarint(
+		std::string& out /**< : <i>out</i> : The encoded bytes.*/,
+		unsigned long long value /**< : <i>in</i> : The value.*/
+	)
+	{
+		for (; value >= 0x80; value >>= 7)
+			out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		out.push_back(static_cast<char>(value));
+	}
+
+	/**
+		\brief A value of a variable encoded for the binary log.
+
+		A tag followed by the value :
+		- `b` bool, `c` character : one byte.
+		- `i` signed integer : zigzag varint.
+		- `u` unsigned integer : varint.
+		- `f` float, `d` double : bits, lowest byte first.
+		- `s` string : varint length, bytes.
+
+		Types not listed are stored as the string of stream insertion.
+
+		hasErrorHandlers        = false;\n
+	*/
+	class log_value
+	{
+		std::string bytes;
+
+		void appendString(std::string_view value)
+		{
+			bytes.push_back('s');
+			appendVarint(bytes, value.size());
+			bytes.append(value.data(), value.size());
+		}
+
+		template<class bits_type, class float_type>
+		void appendFloat(char tag, float_type value)
+		{
+			bits_type bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			bytes.push_back(tag);
+			for (std::size_t i = 0; i < sizeof(bits); ++i, bits >>= 8)
+				bytes.push_back(static_cast<char>(bits & 0xFF));
+		}
+
+	public:
+
+		/**
+			\brief Encodes val.
+		*/
+		template<class T>
+		explicit log_value(
+			const T& val /**< : <i>in</i> : The value.*/
+		)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				bytes.push_back('b');
+				bytes.push_back(val ? 1 : 0);
+			}
+			else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char>
+				|| std::is_same_v<T, unsigned char>)
+			{
+				bytes.push_back('c');
+				bytes.push_back(static_cast<char>(val));
+			}
+			else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+			{
+				bytes.push_back('i');
+				unsigned long long value = static_cast<unsigned long long>(val);
+				appendVarint(bytes, val < 0 ? ((~value) << 1) | 1 : value << 1);
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				bytes.push_back('u');
+				appendVarint(bytes, val);
+			}
+			else if constexpr (std::is_same_v<T, float>)
+				appendFloat<std::uint32_t>('f', val);
+			else if constexpr (std::is_same_v<T, double>)
+				appendFloat<std::uint64_t>('d', val);
+			else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				appendString(val);
+			else
+			{
+				std::ostringstream out;
+				out << val;
+				appendString(out.str());
+			}
+		}
+
+		/**
+			\brief The encoded bytes.
+
+			<h3>Return</h3>
+			The tag and value.
+		*/
+		const std::string& encoded() const noexcept { return bytes; }
+	};
+
 
 	/**
 		\brief The file to get which file to log into.
 
+		The file is named for the first function that logged in thread id. 
+		The calling thread caches its own file on its first log.
+
 		<h3>Return</h3>
 		The path of file.
 
@@ -168,6 +351,182 @@ namespace debug
 		std::string descr /**< : <i>in</i> : The string to log.*/
 	);
 
+	/**
+		\brief The enumeration of what a logging call site logs.
+	*/
+	enum class log_kind : unsigned char
+	{
+		LINE,	/**< \brief Line completion, LOG_LINE.*/
+		DESC,	/**< \brief A description, LOG_DESC.*/
+		VALUE	/**< \brief A variable state, LOG_VAL.*/
+	};
+
+	/**
+		\brief The description of a logging call site, a constant emitted by 
+		each use of the logging macros.
+	*/
+	struct log_site
+	{
+		const char* file;		/**< \brief The file of the call.*/
+		const char* function;	/**< \brief The function of the call.*/
+		unsigned long line;		/**< \brief The line of the call.*/
+		unsigned level;			/**< \brief The optimisation level from 
+								which the call is removed, 5 for calls 
+								without a level.*/
+		log_kind kind;			/**< \brief What is logged.*/
+		const char* var;		/**< \brief The logged expression for 
+								log_kind::VALUE, empty otherwise.*/
+	};
+
+	/**
+		\brief Adds site to the call sites returned by getLogSites and sets
+		enabled by the optimisation levels set at runtime.
+
+		<h3>Return</h3>
+		true.
+	*/
+	bool registerLogSite(
+		const log_site& site /**< : <i>in</i> : The call site.*/,
+		std::atomic<bool>& enabled /**< : <i>out</i> : If site logs.*/
+	);
+
+	/**
+		\brief The call sites of logging macros in the program.
+
+		Sites are registered before main, except those in libraries loaded
+		later.
+
+		<h3>Return</h3>
+		The call sites in order of registration.
+	*/
+	std::vector<const log_site*> getLogSites();
+
+	/**
+		\brief Registers site during static initialisation.
+	*/
+	template<const log_site* site>
+	struct log_site_registrar
+	{
+		/**
+			\brief If site logs, read by the logging macros.
+		*/
+		static inline std::atomic<bool> enabled{ true };
+
+		/**
+			\brief true, set by registering site.
+		*/
+		static inline const bool registered = registerLogSite(*site, enabled);
+	};
+
+	/**
+		\brief Sets the optimisation level at runtime, call sites of levels 
+		up to optimisation are skipped as if ENH_OPTIMISATION was 
+		optimisation.
+
+		Sites removed by ENH_OPTIMISATION can not be enabled. Default is 0, 
+		or the value of environment variable `ENH_LOG_OPTIMISATION`.
+	*/
+	void setLogOptimisation(
+		unsigned optimisation /**< : <i>in</i> : The level, 5 skips all.*/
+	);
+
+	/**
+		\brief Sets the optimisation level at runtime for call sites in file,
+		overrides the level for all files.
+
+		file matches a site if equal to its file or to a trailing part of its
+		path, "timer.enh.h" matches "src/Header/timer.enh.h".
+	*/
+	void setLogOptimisation(
+		std::string_view file /**< : <i>in</i> : The file.*/,
+		unsigned optimisation /**< : <i>in</i> : The level, 5 skips all.*/
+	);
+
+	/**
+		\brief Sets the optimisation level at runtime for call sites at line
+		of file, overrides the level for the file.
+	*/
+	void setLogOptimisation(
+		std::string_view file /**< : <i>in</i> : The file, matched as for 
+							  the level of a file.*/,
+		unsigned long line /**< : <i>in</i> : The line.*/,
+		unsigned optimisation /**< : <i>in</i> : The level, 5 skips all.*/
+	);
+
+	/**
+		\brief Removes the optimisation levels set for files and lines.
+	*/
+	void clearLogOptimisation();
+
+	/**
+		\brief The optimisation level at runtime for all files.
+	*/
+	unsigned getLogOptimisation();
+
+	/**
+		\brief Logs line completion at site to a file indicated by current 
+		thread.
+	*/
+	void Log(
+		const log_site& site /**< : <i>in</i> : The call site.*/
+	);
+
+	/**
+		\brief Logs the text form of the value at site to the text file
+		indicated by current thread.
+	*/
+	void LogText(
+		const log_site& site /**< : <i>in</i> : The call site.*/,
+		std::string_view text /**< : <i>in</i> : The value formatted.*/
+	);
+
+	/**
+		\brief Logs the encoded value at site to the binary file indicated 
+		by current thread.
+	*/
+	void LogEncoded(
+		const log_site& site /**< : <i>in</i> : The call site.*/,
+		const log_value& val /**< : <i>in</i> : The value encoded.*/
+	);
+
+	/**
+		\brief Logs a description or a value at site to a file indicated by 
+		current thread.
+
+		The type should be accepted by the stream insertion operator.
+	*/
+	template<class T>
+	void Log(
+		const log_site& site /**< : <i>in</i> : The call site.*/,
+		const T& val /**< : <i>in</i> : The description or value.*/
+	)
+	{
+		if (getLogFormat() == log_format::BINARY)
+			LogEncoded(site, log_value(val));
+		else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+			LogText(site, val);
+		else
+		{
+			std::ostringstream out;
+			out << val;
+			LogText(site, out.str());
+		}
+	}
+
+	/**
+		\brief Logs calling line, function, file and an encoded value to the
+		binary file indicated by current thread.
+	*/
+	void LogEncoded(
+		std::string file /**< : <i>in</i> : The file in which logging code is 
+						 present.*/,
+		std::string function /**< : <i>in</i> : Logging function name.*/,
+		unsigned long line /**< : <i>in</i> : The line of file in which 
+						   logging code is present.*/,
+		std::string var /**< : <i>in</i> : The name of variable.*/,
+		const log_value& val /**< : <i>in</i> : The encoded value.*/
+	);
+
 	/**
 		\brief Logs calling line, function, file and a value to a file
 		indicated by current thread.
@@ -185,6 +544,11 @@ namespace debug
 		const T& val /**< : <i>in</i> : The value of the variable.*/
 	)
 	{
+		if (getLogFormat() == log_format::BINARY)
+		{
+			LogEncoded(file, function, line, var, log_value(val));
+			return;
+		}
 		std::ostringstream out;
 		out << std::setw(80) << file << " : " << std::setw(6) << line << "   " << std::setw(15) << function << "  " << var << " = " << val;
 		Log(out.str(),function);
@@ -648,343 +1012,390 @@ namespace debug
 */
 #define INFO_FOR_LOG		__FILE__,__func__,__LINE__
 
+/**
+	\brief The Macro to declare the call site of a logging macro as 
+	`enh_log_site_`, registered before main.
+
+	The initialiser is parenthesised to pass through REPLACE(x) as one 
+	argument.
+*/
+#define ENH_LOG_SITE(level, kind, var)		\
+	static constexpr debug::log_site enh_log_site_ = (debug::log_site{ __FILE__, __func__,	\
+		__LINE__, level, debug::log_kind::kind, var });	\
+	static_cast<void>(debug::log_site_registrar<&enh_log_site_>::registered)
+
+/**
+	\brief The Macro to check if `enh_log_site_` logs by the optimisation 
+	level set at runtime, a relaxed atomic load.
+*/
+#define ENH_LOG_ENABLED		\
+	debug::log_site_registrar<&enh_log_site_>::enabled.load(std::memory_order_relaxed)
+
+/**
+	\brief The Macro to log line completion, removed from optimisation 
+	level.
+
+	Passes only the call site to debug::Log, if enabled at runtime.
+*/
+#define LOG_LINE_AT(level)		\
+	do { ENH_LOG_SITE(level, LINE, ""); if (ENH_LOG_ENABLED) debug::Log(enh_log_site_); } while (false)
+
+/**
+	\brief The Macro to log a string, removed from optimisation level.
+
+	Passes only the call site and x to debug::Log, x is evaluated if 
+	enabled at runtime.
+*/
+#define LOG_DESC_AT(level, x)		\
+	do { ENH_LOG_SITE(level, DESC, ""); if (ENH_LOG_ENABLED) debug::Log(enh_log_site_, x); } while (false)
+
+/**
+	\brief The Macro to log a variable state, removed from optimisation 
+	level.
+
+	Passes only the call site and x to debug::Log, x is evaluated if 
+	enabled at runtime.
+*/
+#define LOG_VAL_AT(level, x)		\
+	do { ENH_LOG_SITE(level, VALUE, #x); if (ENH_LOG_ENABLED) debug::Log(enh_log_site_, x); } while (false)
+
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(5) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined.
 */
-#define LOG_LINE REPLACE(debug::Log(INFO_FOR_LOG))
+#define LOG_LINE REPLACE(LOG_LINE_AT(5))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined.
 */
-#define LOG_DESC(x) REPLACE(debug::Log(INFO_FOR_LOG,x))
+#define LOG_DESC(x) REPLACE(LOG_DESC_AT(5,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,#x,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined.
 */
-#define LOG_VAL(x) REPLACE(debug::Log(INFO_FOR_LOG,#x,x))
+#define LOG_VAL(x) REPLACE(LOG_VAL_AT(5,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(5) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined 
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined.
 */
-#define LIB_LOG_LINE LIB_REPLACE(debug::Log(INFO_FOR_LOG))
+#define LIB_LOG_LINE LIB_REPLACE(LOG_LINE_AT(5))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined 
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined.
 */
-#define LIB_LOG_DESC(x) LIB_REPLACE(debug::Log(INFO_FOR_LOG,x))
+#define LIB_LOG_DESC(x) LIB_REPLACE(LOG_DESC_AT(5,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,#x,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined 
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined.
 */
-#define LIB_LOG_VAL(x) LIB_REPLACE(debug::Log(INFO_FOR_LOG,#x,x))
+#define LIB_LOG_VAL(x) LIB_REPLACE(LOG_VAL_AT(5,x))
 
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(5) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 4.
 */
-#define O5_LOG_LINE		O5_REPLACE(LOG_LINE)
+#define O5_LOG_LINE		O5_REPLACE(LOG_LINE_AT(5))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 4.
 */
-#define O5_LOG_DESC(x)	O5_REPLACE(LOG_DESC(x))
+#define O5_LOG_DESC(x)	O5_REPLACE(LOG_DESC_AT(5,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG, #x, x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 4.
 */
-#define O5_LOG_VAL(x)	O5_REPLACE(LOG_VAL(x))
+#define O5_LOG_VAL(x)	O5_REPLACE(LOG_VAL_AT(5,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(4) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 3.
 */
-#define O4_LOG_LINE		O4_REPLACE(LOG_LINE)
+#define O4_LOG_LINE		O4_REPLACE(LOG_LINE_AT(4))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(4,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 3.
 */
-#define O4_LOG_DESC(x)	O4_REPLACE(LOG_DESC(x))
+#define O4_LOG_DESC(x)	O4_REPLACE(LOG_DESC_AT(4,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG, #x, x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(4,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 3.
 */
-#define O4_LOG_VAL(x)	O4_REPLACE(LOG_VAL(x))
+#define O4_LOG_VAL(x)	O4_REPLACE(LOG_VAL_AT(4,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(3) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 2.
 */
-#define O3_LOG_LINE		O3_REPLACE(LOG_LINE)
+#define O3_LOG_LINE		O3_REPLACE(LOG_LINE_AT(3))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(3,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 2.
 */
-#define O3_LOG_DESC(x)	O3_REPLACE(LOG_DESC(x))
+#define O3_LOG_DESC(x)	O3_REPLACE(LOG_DESC_AT(3,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG, #x, x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(3,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 2.
 */
-#define O3_LOG_VAL(x)	O3_REPLACE(LOG_VAL(x))
+#define O3_LOG_VAL(x)	O3_REPLACE(LOG_VAL_AT(3,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(2) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 1.
 */
-#define O2_LOG_LINE		O2_REPLACE(LOG_LINE)
+#define O2_LOG_LINE		O2_REPLACE(LOG_LINE_AT(2))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(2,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 1.
 */
-#define O2_LOG_DESC(x)	O2_REPLACE(LOG_DESC(x))
+#define O2_LOG_DESC(x)	O2_REPLACE(LOG_DESC_AT(2,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG, #x, x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(2,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 1.
 */
-#define O2_LOG_VAL(x)	O2_REPLACE(LOG_VAL(x))
+#define O2_LOG_VAL(x)	O2_REPLACE(LOG_VAL_AT(2,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(1) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 0.
 */
-#define O1_LOG_LINE		O1_REPLACE(LOG_LINE)
+#define O1_LOG_LINE		O1_REPLACE(LOG_LINE_AT(1))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(1,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 0.
 */
-#define O1_LOG_DESC(x)	O1_REPLACE(LOG_DESC(x))
+#define O1_LOG_DESC(x)	O1_REPLACE(LOG_DESC_AT(1,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG, #x, x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(1,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if ENH_OPTIMISATION is greater than 0.
 */
-#define O1_LOG_VAL(x)	O1_REPLACE(LOG_VAL(x))
+#define O1_LOG_VAL(x)	O1_REPLACE(LOG_VAL_AT(1,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(5) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is 
 	greater than 4.
 */
-#define O5_LIB_LOG_LINE		O5_LIB_REPLACE(LIB_LOG_LINE)
+#define O5_LIB_LOG_LINE		O5_LIB_REPLACE(LOG_LINE_AT(5))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is 
 	greater than 4.
 */
-#define O5_LIB_LOG_DESC(x)	O5_LIB_REPLACE(LIB_LOG_DESC(x))
+#define O5_LIB_LOG_DESC(x)	O5_LIB_REPLACE(LOG_DESC_AT(5,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,#x,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(5,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is 
 	greater than 4.
 */
-#define O5_LIB_LOG_VAL(x)	O5_LIB_REPLACE(LIB_LOG_VAL(x))
+#define O5_LIB_LOG_VAL(x)	O5_LIB_REPLACE(LOG_VAL_AT(5,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(4) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 3.
 */
-#define O4_LIB_LOG_LINE		O4_LIB_REPLACE(LIB_LOG_LINE)
+#define O4_LIB_LOG_LINE		O4_LIB_REPLACE(LOG_LINE_AT(4))
 
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(4,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 3.
 */
-#define O4_LIB_LOG_DESC(x)	O4_LIB_REPLACE(LIB_LOG_DESC(x))
+#define O4_LIB_LOG_DESC(x)	O4_LIB_REPLACE(LOG_DESC_AT(4,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,#x,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(4,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 3.
 */
-#define O4_LIB_LOG_VAL(x)	O4_LIB_REPLACE(LIB_LOG_VAL(x))
+#define O4_LIB_LOG_VAL(x)	O4_LIB_REPLACE(LOG_VAL_AT(4,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(3) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 2.
 */
-#define O3_LIB_LOG_LINE		O3_LIB_REPLACE(LIB_LOG_LINE)
+#define O3_LIB_LOG_LINE		O3_LIB_REPLACE(LOG_LINE_AT(3))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(3,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 2.
 */
-#define O3_LIB_LOG_DESC(x)	O3_LIB_REPLACE(LIB_LOG_DESC(x))
+#define O3_LIB_LOG_DESC(x)	O3_LIB_REPLACE(LOG_DESC_AT(3,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,#x,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(3,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 2.
 */
-#define O3_LIB_LOG_VAL(x)	O3_LIB_REPLACE(LIB_LOG_VAL(x))
+#define O3_LIB_LOG_VAL(x)	O3_LIB_REPLACE(LOG_VAL_AT(3,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(2) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 1.
 */
-#define O2_LIB_LOG_LINE		O2_LIB_REPLACE(LIB_LOG_LINE)
+#define O2_LIB_LOG_LINE		O2_LIB_REPLACE(LOG_LINE_AT(2))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(2,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 1.
 */
-#define O2_LIB_LOG_DESC(x)	O2_LIB_REPLACE(LIB_LOG_DESC(x))
+#define O2_LIB_LOG_DESC(x)	O2_LIB_REPLACE(LOG_DESC_AT(2,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,#x,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(2,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 1.
 */
-#define O2_LIB_LOG_VAL(x)	O2_LIB_REPLACE(LIB_LOG_VAL(x))
+#define O2_LIB_LOG_VAL(x)	O2_LIB_REPLACE(LOG_VAL_AT(2,x))
 
 /**
 	\brief The Macro to log line completion in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG) if DEBUG is defined.\n\n
+	Evaluates to LOG_LINE_AT(1) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 0.
 */
-#define O1_LIB_LOG_LINE		O1_LIB_REPLACE(LIB_LOG_LINE)
+#define O1_LIB_LOG_LINE		O1_LIB_REPLACE(LOG_LINE_AT(1))
 
 /**
 	\brief The Macro to log a string in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_DESC_AT(1,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 0.
 */
-#define O1_LIB_LOG_DESC(x)	O1_LIB_REPLACE(LIB_LOG_DESC(x))
+#define O1_LIB_LOG_DESC(x)	O1_LIB_REPLACE(LOG_DESC_AT(1,x))
 
 /**
 	\brief The Macro to log a variable state in debug mode.
 
-	Evaluates to debug::Log(INFO_FOR_LOG,#x,x) if DEBUG is defined.\n\n
+	Evaluates to LOG_VAL_AT(1,x) if DEBUG is defined.\n\n
 	Evaluates to blank if DEBUG is not defined or if ENH_CLEAR_OP__ is defined
 	or if IGNORE_ENHANCE_DIAGNOSTICS is defined	or if ENH_OPTIMISATION is
 	greater than 0.
 */
-#define O1_LIB_LOG_VAL(x)	O1_LIB_REPLACE(LIB_LOG_VAL(x))
+#define O1_LIB_LOG_VAL(x)	O1_LIB_REPLACE(LOG_VAL_AT(1,x))
 #endif // !LOGGER_ENH_H
 
 
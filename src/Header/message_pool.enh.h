@@ -0,0 +1,334 @@
+/** ***************************************************************************
+	\file message_pool.enh.h
+
+	\brief The file to declare class message_pool and class pooled
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+******************************************************************************/
+
+#ifndef MESSAGE_POOL_ENH_H
+
+#define MESSAGE_POOL_ENH_H						message_pool.enh.h
+
+#include "queue_backend.enh.h"
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace enh
+{
+
+	template<class T>
+	class message_pool;
+
+	/**
+		\brief The storage of a payload in message_pool.
+	*/
+	template<class T>
+	struct pool_node
+	{
+		T value; /**< \brief The payload.*/
+		pool_node* next; /**< \brief The next node in a free list.*/
+		pool_node* link; /**< \brief The next node of all allocated.*/
+	};
+
+	/**
+		\brief Template type to check whether a type provides clear.
+
+		<h3>Template Parameter</h3>
+		-#  <code>T</code> : The type to check.
+
+		<h3>Values </h3>
+		<code>true</code> if `T::clear()` can be called.\n
+		false for all else.\n
+	*/
+	template<class T, class = void>
+	constexpr bool canClear_v = false;
+
+	template<class T>
+	constexpr bool canClear_v<T, std::void_t<decltype(std::declval<T&>().clear())>> = true;
+
+	/**
+		\brief The envelope which owns a payload taken from a message_pool and
+		returns it to the pool when destroyed.
+
+
+		hasErrorHandlers        = false;\n
+
+		Can be moved, not copied. Can be destroyed on any thread, it is meant
+		to be carried in a message (as a field of gen_instruct for example)
+		and destroyed by the worker after processing.
+
+		<h3>Template arguments</h3>
+		-#  <code>class T</code> : The type of payload.\n
+	*/
+	template<class T>
+	class pooled
+	{
+		/**
+			\brief The pool payload is returned to, null if empty.
+		*/
+		message_pool<T>* pool;
+
+		/**
+			\brief The storage of payload, null if empty.
+		*/
+		pool_node<T>* payload;
+
+		friend class message_pool<T>;
+
+		/**
+			\brief Constructs the envelope of a payload.
+		*/
+		pooled(
+			message_pool<T>* owner /**< : <i>in</i> : The pool.*/,
+			pool_node<T>* value /**< : <i>in</i> : The payload.*/
+		) noexcept : pool(owner), payload(value) {}
+
+	public:
+
+		/**
+			\brief Constructs an empty envelope.
+		*/
+		pooled() noexcept : pool(nullptr), payload(nullptr) {}
+
+		/**
+			\brief The move constructor, other is left empty.
+		*/
+		pooled(
+			pooled&& other /**< : <i>in</i> : The envelope moved from.*/
+		) noexcept : pool(other.pool), payload(other.payload)
+		{
+			other.pool = nullptr;
+			other.payload = nullptr;
+		}
+
+		/**
+			\brief The move assignment, returns the payload held before.
+		*/
+		pooled& operator = (
+			pooled&& other /**< : <i>in</i> : The envelope moved from.*/
+			) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				std::swap(pool, other.pool);
+				std::swap(payload, other.payload);
+			}
+			return *this;
+		}
+
+		pooled(const pooled&) = delete;
+
+		pooled& operator = (const pooled&) = delete;
+
+		/**
+			\brief Returns the payload to its pool and leaves envelope empty.
+		*/
+		inline void reset() noexcept
+		{
+			if (pool)
+				pool->release(payload);
+			pool = nullptr;
+			payload = nullptr;
+		}
+
+		/**
+			\brief true if the envelope holds a payload.
+		*/
+		inline explicit operator bool() const noexcept { return payload != nullptr; }
+
+		/**
+			\brief The payload.
+		*/
+		inline T& operator *() const noexcept { return payload->value; }
+
+		/**
+			\brief The payload.
+		*/
+		inline T* operator ->() const noexcept { return &payload->value; }
+
+		/**
+			\brief The payload, null if empty.
+		*/
+		inline T* get() const noexcept 
+		{ 
+			return payload ? &payload->value : nullptr; 
+		}
+
+		/**
+			\brief The destructor, returns the payload to its pool.
+		*/
+		~pooled()
+		{
+			reset();
+		}
+	};
+
+	/**
+		\brief The class to recycle payloads of messages, so strings or
+		vectors posted to a queue keep their storage instead of being
+		allocated by the producer and freed by the worker each time.
+
+
+		hasErrorHandlers        = false;\n
+
+		A pool is owned by one producer thread, only it may call `acquire`.
+		Payloads are returned from any thread to a lock-free list which the
+		owner takes over as a whole when its own free list is empty, so
+		returning never contends with the allocator of the producer.
+
+		Payloads are never freed while the pool lives, the pool grows to the
+		largest number of payloads in use at once.
+
+		<b>Note</b> : The pool must outlive all envelopes taken from it.
+
+		<h3>Template arguments</h3>
+		-#  <code>class T</code> : The type of payload, must be default
+		constructible.\n
+
+
+		<h3> How To Use </h3>
+
+		- Create one `message_pool<std::string>` per producer thread.
+
+		- Call `acquire` to get a `pooled<std::string>`, fill it and post it
+		as a message or a field of one.
+
+		- The worker processes it, when the message is destroyed the string
+		goes back to the pool with its capacity.
+
+	*/
+	template<class T>
+	class message_pool
+	{
+		/**
+			\brief The storage of a payload.
+		*/
+		using node = pool_node<T>;
+
+		/**
+			\brief The nodes ready to be taken, only used by owner.
+		*/
+		node* free_list;
+
+		/**
+			\brief All nodes allocated, to free them.
+		*/
+		node* all;
+
+		/**
+			\brief The number of nodes allocated.
+		*/
+		std::size_t count;
+
+		/**
+			\brief The nodes returned by other threads.
+		*/
+		alignas(cache_line_size) std::atomic<node*> returned;
+
+		friend class pooled<T>;
+
+		/**
+			\brief Returns a payload to the pool, called from any thread.
+		*/
+		inline void release(
+			node* n /**< : <i>in</i> : The payload.*/
+		) noexcept
+		{
+			n->next = returned.load(std::memory_order_relaxed);
+			while (!returned.compare_exchange_weak(n->next, n,
+				std::memory_order_release, std::memory_order_relaxed))
+				;
+		}
+
+	public:
+
+		static_assert(std::is_default_constructible_v<T>, 
+			"payload must be default constructible");
+
+		/**
+			\brief Constructs an empty pool.
+		*/
+		message_pool() noexcept : free_list(nullptr), all(nullptr), count(0),
+			returned(nullptr) {}
+
+		message_pool(const message_pool&) = delete;
+
+		message_pool(message_pool&&) = delete;
+
+		message_pool& operator = (message_pool&&) = delete;
+
+		message_pool& operator = (const message_pool&) = delete;
+
+		/**
+			\brief Takes a payload from the pool, only called by the owner 
+			thread. The payload is cleared if T has `clear()`, keeping its
+			storage, else it holds the value of its last use.
+
+			<h3>Return</h3>
+			The envelope owning the payload.\n
+		*/
+		pooled<T> acquire()
+		{
+			if (!free_list)
+				free_list = returned.exchange(nullptr, std::memory_order_acquire);
+			node* n = free_list;
+			if (n)
+			{
+				free_list = n->next;
+				if constexpr (canClear_v<T>)
+					n->value.clear();
+			}
+			else
+			{
+				n = new node{ T(), nullptr, all };
+				all = n;
+				++count;
+			}
+			return pooled<T>(this, n);
+		}
+
+		/**
+			\brief The number of payloads allocated by the pool.
+		*/
+		inline std::size_t allocated() const noexcept { return count; }
+
+		/**
+			\brief The destructor, frees all payloads.
+		*/
+		~message_pool()
+		{
+			while (all)
+			{
+				node* n = all;
+				all = n->link;
+				delete n;
+			}
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,1139 @@
+/** ***************************************************************************
+	\file pipeline.enh.h
+
+	\brief The file to declare class pipeline and class pipeline_builder
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+******************************************************************************/
+
+#ifndef PIPELINE_ENH_H
+
+#define PIPELINE_ENH_H						pipeline.enh.h
+
+#include "error_base.enh.h"
+#include "queue_backend.enh.h"
+#include "histogram.enh.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace enh
+{
+
+	/**
+		\brief The bounded lock-free queue between exactly one producer
+		thread and one consumer thread.
+
+
+		hasErrorHandlers        = false;\n
+
+		Each side keeps a cached copy of the position of the other, so the
+		shared positions are read only when the cached one says full or
+		empty.
+
+		<h3>Template arguments</h3>
+		-#  <code>class T</code> : The type of message stored, must be move
+		constructible without throwing.\n
+	*/
+	template<class T>
+	class spsc_ring
+	{
+	public:
+
+		/**
+			\brief The type of message stored.
+		*/
+		using value_type = T;
+
+	private:
+
+		/**
+			\brief The storage of one message.
+		*/
+		struct slot
+		{
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		/**
+			\brief capacity - 1, capacity is a power of 2.
+		*/
+		std::size_t mask;
+
+		/**
+			\brief The storage of messages.
+		*/
+		std::unique_ptr<slot[]> slots;
+
+		/**
+			\brief The position of next message to pop, written by consumer.
+		*/
+		alignas(cache_line_size) std::atomic<std::size_t> head;
+
+		/**
+			\brief The last tail seen by consumer.
+		*/
+		std::size_t cached_tail;
+
+		/**
+			\brief The position of next message to push, written by producer.
+		*/
+		alignas(cache_line_size) std::atomic<std::size_t> tail;
+
+		/**
+			\brief The last head seen by producer.
+		*/
+		std::size_t cached_head;
+
+		/**
+			\brief The message at a position.
+		*/
+		inline T* at(
+			std::size_t pos /**< : <i>in</i> : The position.*/
+		) const noexcept
+		{
+			return std::launder(reinterpret_cast<T*>(slots[pos & mask].storage));
+		}
+
+	public:
+
+		/**
+			\brief Constructs the ring with at least the capacity passed,
+			rounded up to a power of 2.
+		*/
+		explicit spsc_ring(
+			std::size_t capacity /**< : <i>in</i> : The minimum capacity.*/
+		) : mask(0), slots(), head(0), cached_tail(0), tail(0), cached_head(0)
+		{
+			std::size_t size = 2;
+			while (size < capacity)
+				size *= 2;
+			mask = size - 1;
+			slots.reset(new slot[size]);
+		}
+
+		spsc_ring(const spsc_ring&) = delete;
+
+		spsc_ring& operator = (const spsc_ring&) = delete;
+
+		/**
+			\brief Adds message to the ring, called only by the producer.
+
+			<h3>Return</h3>
+			false without consuming message if ring is full.\n
+		*/
+		inline bool push(
+			value_type&& Message /**< : <i>in</i> : Message to be added.*/
+		)
+		{
+			std::size_t pos = tail.load(std::memory_order_relaxed);
+			if (pos - cached_head > mask)
+			{
+				cached_head = head.load(std::memory_order_acquire);
+				if (pos - cached_head > mask)
+					return false;
+			}
+			new (slots[pos & mask].storage) T(std::move(Message));
+			tail.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+			\brief Removes the oldest message, called only by the consumer.
+
+			<h3>Return</h3>
+			The message removed, or empty if ring was empty.\n
+		*/
+		inline std::optional<value_type> pop()
+		{
+			std::size_t pos = head.load(std::memory_order_relaxed);
+			if (pos == cached_tail)
+			{
+				cached_tail = tail.load(std::memory_order_acquire);
+				if (pos == cached_tail)
+					return std::nullopt;
+			}
+			T* msg = at(pos);
+			std::optional<value_type> ret(std::move(*msg));
+			msg->~T();
+			head.store(pos + 1, std::memory_order_release);
+			return ret;
+		}
+
+		/**
+			\brief true if no message is stored.
+		*/
+		inline bool empty() const noexcept
+		{
+			return head.load() == tail.load();
+		}
+
+		/**
+			\brief The destructor, destroys messages left.
+		*/
+		~spsc_ring()
+		{
+			for (std::size_t pos = head.load(); pos != tail.load(); ++pos)
+				at(pos)->~T();
+		}
+	};
+
+	/**
+		\brief The structure of statistics of one stage of a pipeline.
+
+		All members can be read from any thread without locking while the
+		pipeline runs. Durations are recorded in nanoseconds.
+	*/
+	struct stage_stats
+	{
+		std::atomic<unsigned long long> processed; /**< \brief Messages passed
+												   to the stage function.*/
+		std::atomic<unsigned long long> filtered; /**< \brief Messages the
+												  stage function returned
+												  nothing for.*/
+		std::atomic<unsigned long long> failed; /**< \brief Messages the sink
+												did not return tristate::GOOD
+												for.*/
+		latency_histogram<> wait_time; /**< \brief Time a message waited in
+									   the link before the stage.*/
+		latency_histogram<> service_time; /**< \brief Time taken by the stage
+										  function.*/
+		latency_histogram<> latency; /**< \brief Time from post till the
+									 stage finished the message.*/
+
+		stage_stats() noexcept : processed(0), filtered(0), failed(0) {}
+	};
+
+	/**
+		\brief The message with its timestamps while it passes through a
+		pipeline.
+	*/
+	template<class T>
+	struct pipeline_item
+	{
+		T value; /**< \brief The message.*/
+		std::chrono::steady_clock::time_point posted; /**< \brief The time it
+													  was posted.*/
+		std::chrono::steady_clock::time_point queued; /**< \brief The time it
+													  entered current link.*/
+	};
+
+	/**
+		\brief The interface of a stage of pipeline, used to run it without
+		knowing its types.
+	*/
+	class pipeline_stage_base
+	{
+	public:
+
+		/**
+			\brief Starts the workers.
+		*/
+		virtual void start() = 0;
+
+		/**
+			\brief Waits till the workers exit.
+		*/
+		virtual void join() noexcept = 0;
+
+		/**
+			\brief Signals the workers to exit without processing messages
+			left.
+		*/
+		virtual void abort() noexcept = 0;
+
+		/**
+			\brief The statistics of stage.
+		*/
+		virtual const stage_stats& stats() const noexcept = 0;
+
+		/**
+			\brief The number of workers.
+		*/
+		virtual unsigned workerCount() const noexcept = 0;
+
+		virtual ~pipeline_stage_base() = default;
+	};
+
+	/**
+		\brief The interface of a stage to pass it messages of type T.
+	*/
+	template<class T>
+	class pipeline_input : public pipeline_stage_base
+	{
+	public:
+
+		/**
+			\brief Passes a message to one of the workers, waits if all of
+			their links from the producer are full.
+
+			<h3>Return</h3>
+			false if stage was aborted, message is destroyed.\n
+		*/
+		virtual bool push(
+			unsigned producer /**< : <i>in</i> : The index of the producer.*/,
+			pipeline_item<T>&& item /**< : <i>in</i> : The message.*/
+		) = 0;
+
+		/**
+			\brief Signals that no more messages will be pushed, the workers
+			exit once the links are empty.
+		*/
+		virtual void close() noexcept = 0;
+	};
+
+	/**
+		\brief The stage of a pipeline which takes messages of type In from
+		the links of the stage before, calls the stage function and passes
+		the result to the next stage.
+
+
+		hasErrorHandlers        = false;\n
+
+		The stage has one spsc_ring for every pair of producer (worker of the
+		stage before or the poster) and worker, so every link has one
+		producer and one consumer. Producers fill the links of the workers
+		round robin, skipping full ones. A producer whose links are all full
+		spins for a while then sleeps till a worker pops from one of them.
+
+		<h3>Template arguments</h3>
+		-#  <code>class In</code> : The type of message taken.\n
+		-#  <code>class Out</code> : The type of message produced, void if
+		the stage is the sink.\n
+	*/
+	template<class In, class Out>
+	class pipeline_stage : public pipeline_input<In>
+	{
+	public:
+
+		/**
+			\brief The function type of the stage, returns nothing to drop
+			the message, the sink returns tristate.
+		*/
+		using stage_method = std::conditional_t<std::is_void_v<Out>,
+			std::function<tristate(In&&)>,
+			std::function<std::optional<std::conditional_t<std::is_void_v<Out>,
+			int, Out>>(In&&)>>;
+
+	private:
+
+		/**
+			\brief The state a worker sleeps on.
+		*/
+		struct alignas(cache_line_size) worker_state
+		{
+			std::mutex mtxWorker; /**< \brief The mutex worker sleeps on.*/
+			std::condition_variable cvWorker; /**< \brief The object to
+											  notify worker.*/
+			std::atomic<bool> isUpdated; /**< \brief true if a message was
+										 pushed since worker last looked.*/
+			std::atomic<bool> isParked; /**< \brief true while worker may
+										sleep.*/
+		};
+
+		/**
+			\brief The worker a producer pushes to next, written only by the
+			producer, and the state it sleeps on while its links are full.
+		*/
+		struct alignas(cache_line_size) producer_cursor
+		{
+			unsigned next; /**< \brief The index of worker.*/
+			std::mutex mtxProducer; /**< \brief The mutex producer sleeps
+									on.*/
+			std::condition_variable cvProducer; /**< \brief The object to
+												notify producer.*/
+			std::atomic<bool> isFreed; /**< \brief true if a message was
+									   popped from a link of the producer
+									   since it last looked.*/
+			std::atomic<bool> isParked; /**< \brief true while producer may
+										sleep.*/
+		};
+
+		/**
+			\brief The number of spins of a worker or producer before 
+			sleeping.
+		*/
+		static constexpr unsigned spin_count = 1024;
+
+		/**
+			\brief The number of messages taken from a link before looking at
+			the next.
+		*/
+		static constexpr unsigned batch_size = 64;
+
+		/**
+			\brief The stage function.
+		*/
+		stage_method fn;
+
+		/**
+			\brief The number of workers.
+		*/
+		unsigned workers;
+
+		/**
+			\brief The capacity of each link.
+		*/
+		std::size_t link_capacity;
+
+		/**
+			\brief The number of producers.
+		*/
+		unsigned producers;
+
+		/**
+			\brief The links, link from producer p to worker w is at
+			p * workers + w.
+		*/
+		std::vector<std::unique_ptr<spsc_ring<pipeline_item<In>>>> links;
+
+		/**
+			\brief The state of workers.
+		*/
+		std::unique_ptr<worker_state[]> state;
+
+		/**
+			\brief The position of next worker to push to for each producer.
+		*/
+		std::unique_ptr<producer_cursor[]> cursors;
+
+		/**
+			\brief The thread handles of workers.
+		*/
+		std::vector<std::thread> threads;
+
+		/**
+			\brief The number of workers running.
+		*/
+		std::atomic<unsigned> running;
+
+		/**
+			\brief true once no more messages will be pushed.
+		*/
+		std::atomic<bool> isClosed;
+
+		/**
+			\brief true to exit without processing messages left.
+		*/
+		std::atomic<bool> isAborted;
+
+		/**
+			\brief The stage messages are passed to, null for sink.
+		*/
+		pipeline_input<std::conditional_t<std::is_void_v<Out>, int, Out>>* next;
+
+		/**
+			\brief The statistics of stage.
+		*/
+		stage_stats counters;
+
+		template<class, class>
+		friend class pipeline_builder;
+
+		/**
+			\brief Wakes a worker if it was not already signalled and may be
+			asleep.
+		*/
+		inline void wake(
+			worker_state& worker /**< : <i>in</i> : The worker.*/
+		)
+		{
+			if (!worker.isUpdated.exchange(true) && worker.isParked.load())
+			{
+				{
+					std::lock_guard<std::mutex> lock(worker.mtxWorker);
+				}
+				worker.cvWorker.notify_one();
+			}
+		}
+
+		/**
+			\brief Wakes a producer if it was not already signalled and may
+			be asleep, called after popping from one of its links.
+		*/
+		inline void wake_producer(
+			producer_cursor& producer /**< : <i>in</i> : The producer.*/
+		)
+		{
+			if (!producer.isFreed.exchange(true) && producer.isParked.load())
+			{
+				{
+					std::lock_guard<std::mutex> lock(producer.mtxProducer);
+				}
+				producer.cvProducer.notify_one();
+			}
+		}
+
+		/**
+			\brief Wakes all workers for close or abort.
+		*/
+		inline void wake_all() noexcept
+		{
+			for (unsigned i = 0; i < workers; ++i)
+			{
+				{
+					std::lock_guard<std::mutex> lock(state[i].mtxWorker);
+				}
+				state[i].cvWorker.notify_all();
+			}
+		}
+
+		/**
+			\brief Wakes all producers waiting for space for abort.
+		*/
+		inline void wake_producers() noexcept
+		{
+			for (unsigned i = 0; i < producers; ++i)
+			{
+				{
+					std::lock_guard<std::mutex> lock(cursors[i].mtxProducer);
+				}
+				cursors[i].cvProducer.notify_all();
+			}
+		}
+
+		/**
+			\brief Waits till a message is pushed or stage is closed or
+			aborted, spins for a while before sleeping.
+		*/
+		inline void wait(
+			worker_state& self /**< : <i>in</i> : The worker.*/
+		)
+		{
+			auto ready = [&]() {
+				return self.isUpdated.load() || isClosed.load() ||
+					isAborted.load();
+			};
+			for (unsigned i = 0; i < spin_count; ++i)
+			{
+				if (ready())
+					return;
+				cpu_relax(i);
+			}
+			self.isParked.store(true);
+			{
+				std::unique_lock<std::mutex> lock(self.mtxWorker);
+				self.cvWorker.wait(lock, ready);
+			}
+			self.isParked.store(false);
+		}
+
+		/**
+			\brief Calls the stage function on a message and passes result on.
+		*/
+		void process(
+			unsigned index /**< : <i>in</i> : The index of worker.*/,
+			pipeline_item<In>&& item /**< : <i>in</i> : The message.*/
+		)
+		{
+			auto taken = std::chrono::steady_clock::now();
+			counters.wait_time.record(taken - item.queued);
+			if constexpr (std::is_void_v<Out>)
+			{
+				tristate ret = fn(std::move(item.value));
+				auto done = std::chrono::steady_clock::now();
+				counters.service_time.record(done - taken);
+				counters.latency.record(done - item.posted);
+				++counters.processed;
+				if (!ret)
+					++counters.failed;
+				(void)index;
+			}
+			else
+			{
+				auto out = fn(std::move(item.value));
+				auto done = std::chrono::steady_clock::now();
+				counters.service_time.record(done - taken);
+				counters.latency.record(done - item.posted);
+				++counters.processed;
+				if (!out)
+				{
+					++counters.filtered;
+					return;
+				}
+				next->push(index, pipeline_item<Out>{ std::move(*out),
+					item.posted, done });
+			}
+		}
+
+		/**
+			\brief loops and processes messages from the links of the worker
+			till stage is closed and links are empty, or aborted.
+		*/
+		void run(
+			unsigned index /**< : <i>in</i> : The index of worker.*/
+		) noexcept
+		{
+			O1_LIB_LOG_LINE;
+			worker_state& self = state[index];
+			unsigned first = 0;
+			while (!isAborted.load())
+			{
+				bool was_closed = isClosed.load();
+				self.isUpdated.exchange(false);
+				bool found = false;
+				for (unsigned p = 0; p < producers && !isAborted.load(); ++p)
+				{
+					unsigned producer = (first + p) % producers;
+					auto& link = *links[producer * workers + index];
+					unsigned n = 0;
+					for (; n < batch_size; ++n)
+					{
+						std::optional<pipeline_item<In>> item = link.pop();
+						if (!item)
+							break;
+						process(index, std::move(*item));
+					}
+					if (n != 0)
+					{
+						found = true;
+						wake_producer(cursors[producer]);
+					}
+				}
+				++first;
+				if (found)
+					continue;
+				if (was_closed)
+					break;
+				wait(self);
+			}
+			O4_LIB_LOG_LINE;
+			if (--running == 0)
+			{
+				if constexpr (!std::is_void_v<Out>)
+					next->close();
+			}
+		}
+
+	public:
+
+		/**
+			\brief Constructs the stage.
+		*/
+		pipeline_stage(
+			stage_method f /**< : <i>in</i> : The stage function.*/,
+			unsigned count /**< : <i>in</i> : The number of workers.*/,
+			std::size_t capacity /**< : <i>in</i> : The capacity of each link.*/
+		) : fn(std::move(f)), workers(count ? count : 1), link_capacity(capacity),
+			producers(0), state(new worker_state[workers]), running(0),
+			isClosed(false), isAborted(false), next(nullptr)
+		{
+			for (unsigned i = 0; i < workers; ++i)
+			{
+				state[i].isUpdated = false;
+				state[i].isParked = false;
+			}
+		}
+
+		/**
+			\brief Creates the links from the producers.
+		*/
+		void attach(
+			unsigned count /**< : <i>in</i> : The number of producers.*/
+		)
+		{
+			producers = count;
+			cursors.reset(new producer_cursor[producers]);
+			for (unsigned i = 0; i < producers; ++i)
+			{
+				cursors[i].next = i % workers;
+				cursors[i].isFreed = false;
+				cursors[i].isParked = false;
+			}
+			links.clear();
+			for (unsigned i = 0; i < producers * workers; ++i)
+				links.emplace_back(new spsc_ring<pipeline_item<In>>(link_capacity));
+		}
+
+		bool push(
+			unsigned producer,
+			pipeline_item<In>&& item
+		) override
+		{
+			producer_cursor& self = cursors[producer];
+			unsigned& target = self.next;
+			for (unsigned spin = 0; ; ++spin)
+			{
+				// cleared before the links are looked at so a pop after
+				// that sets it.
+				bool parking = spin >= spin_count;
+				if (parking)
+					self.isFreed.exchange(false);
+				for (unsigned i = 0; i < workers; ++i)
+				{
+					unsigned w = (target + i) % workers;
+					item.queued = std::chrono::steady_clock::now();
+					if (links[producer * workers + w]->push(std::move(item)))
+					{
+						target = (w + 1) % workers;
+						wake(state[w]);
+						return true;
+					}
+				}
+				if (isAborted.load())
+					return false;
+				if (!parking)
+				{
+					cpu_relax(spin);
+					continue;
+				}
+				self.isParked.store(true);
+				{
+					std::unique_lock<std::mutex> lock(self.mtxProducer);
+					self.cvProducer.wait(lock, [&]() {
+						return self.isFreed.load() || isAborted.load();
+						});
+				}
+				self.isParked.store(false);
+			}
+		}
+
+		void close() noexcept override
+		{
+			isClosed = true;
+			wake_all();
+		}
+
+		void start() override
+		{
+			running = workers;
+			for (unsigned i = 0; i < workers; ++i)
+				threads.emplace_back(&pipeline_stage::run, this, i);
+		}
+
+		void join() noexcept override
+		{
+			for (auto& i : threads)
+				i.join();
+			threads.clear();
+		}
+
+		void abort() noexcept override
+		{
+			isAborted = true;
+			wake_all();
+			wake_producers();
+		}
+
+		const stage_stats& stats() const noexcept override { return counters; }
+
+		unsigned workerCount() const noexcept override { return workers; }
+	};
+
+	/**
+		\brief Template type to find the type of message a stage function
+		produces, the stage function returns it or an std::optional of it.
+	*/
+	template<class R>
+	struct stage_output
+	{
+		using type = std::decay_t<R>;
+	};
+
+	template<class R>
+	struct stage_output<std::optional<R>>
+	{
+		using type = R;
+	};
+
+	template<class In>
+	class pipeline;
+
+	/**
+		\brief The class to compose the stages of a pipeline.
+
+
+		hasErrorHandlers        = false;\n
+
+		Each call to `stage` adds a stage taking the output of the last and
+		returns the builder for the output type of the new stage, so the
+		types of stages are checked at compile time. `sink` adds the last
+		stage and returns the pipeline.
+
+		<h3>Template arguments</h3>
+		-#  <code>class In</code> : The type of message posted to pipeline.\n
+		-#  <code>class Out</code> : The type of message produced by the last
+		stage added.\n
+	*/
+	template<class In, class Out = In>
+	class pipeline_builder
+	{
+		template<class, class>
+		friend class pipeline_builder;
+
+		/**
+			\brief The stages added.
+		*/
+		std::vector<std::unique_ptr<pipeline_stage_base>> stages;
+
+		/**
+			\brief The first stage, null if none.
+		*/
+		pipeline_input<In>* first;
+
+		/**
+			\brief The pointer to next stage of the last stage, null if none.
+		*/
+		pipeline_input<Out>** last;
+
+		/**
+			\brief The number of workers of last stage.
+		*/
+		unsigned last_workers;
+
+		/**
+			\brief Connects a stage after the last.
+		*/
+		template<class stage_type>
+		void connect(
+			stage_type* added /**< : <i>in</i> : The stage.*/
+		)
+		{
+			if constexpr (std::is_same_v<In, Out>)
+			{
+				if (!last)
+				{
+					first = added;
+					added->attach(1);
+					return;
+				}
+			}
+			*last = added;
+			added->attach(last_workers);
+		}
+
+	public:
+
+		/**
+			\brief Constructs a builder with no stages.
+		*/
+		pipeline_builder() noexcept : first(nullptr), last(nullptr),
+			last_workers(1) {}
+
+		/**
+			\brief Adds a stage.
+
+			<h3>Return</h3>
+			The builder to add stages taking output of this one.\n
+		*/
+		template<class stage_fn>
+		auto stage(
+			stage_fn f /**< : <i>in</i> : The stage function, takes Out and
+					   returns the output or std::optional of it, returning
+					   nothing drops the message.*/,
+			unsigned workers = 1 /**< : <i>in</i> : The number of workers.*/,
+			std::size_t capacity = 1024 /**< : <i>in</i> : The capacity of
+										each link into the stage.*/
+		) &&
+		{
+			using next_type = typename stage_output<
+				std::invoke_result_t<stage_fn&, Out&&>>::type;
+			using stage_type = pipeline_stage<Out, next_type>;
+			std::unique_ptr<stage_type> added(new stage_type(
+				typename stage_type::stage_method(std::move(f)), workers,
+				capacity));
+			connect(added.get());
+			pipeline_builder<In, next_type> ret;
+			ret.stages = std::move(stages);
+			ret.first = first;
+			ret.last = &added->next;
+			ret.last_workers = added->workerCount();
+			ret.stages.push_back(std::move(added));
+			return ret;
+		}
+
+		/**
+			\brief Adds the last stage.
+
+			<h3>Return</h3>
+			The pipeline, not started.\n
+		*/
+		template<class sink_fn>
+		pipeline<In> sink(
+			sink_fn f /**< : <i>in</i> : The function, takes Out and returns
+					  tristate.*/,
+			unsigned workers = 1 /**< : <i>in</i> : The number of workers.*/,
+			std::size_t capacity = 1024 /**< : <i>in</i> : The capacity of
+										each link into the stage.*/
+		) &&
+		{
+			using stage_type = pipeline_stage<Out, void>;
+			std::unique_ptr<stage_type> added(new stage_type(
+				typename stage_type::stage_method(std::move(f)), workers,
+				capacity));
+			connect(added.get());
+			stages.push_back(std::move(added));
+			return pipeline<In>(std::move(stages), first);
+		}
+	};
+
+	/**
+		\brief The class to process messages through a chain of stages, each
+		on its own workers, connected by bounded lock-free links.
+
+
+		hasErrorHandlers        = false;\n
+
+		Messages are passed between stages through one spsc_ring per pair
+		of producer and consumer, so no lock is taken to pass a message. A
+		producer waits while all the links it can push to are full, so a
+		slow stage slows the stages before it instead of growing memory.
+
+		Messages are processed in the order posted by stages with one
+		worker, stages with more workers do not keep the order.
+
+		Statistics of each stage (messages processed, wait, service time and
+		latency from post) are kept always and can be read while running.
+
+		<h3>Template arguments</h3>
+		-#  <code>class In</code> : The type of message posted.\n
+
+
+		<h3> How To Use </h3>
+
+		- Create with `pipeline_builder<In>().stage(parse).stage(enrich, 2)
+		.sink(write)` where each stage function takes the output of the one
+		before. Pass the number of workers and capacity of links after the
+		function.
+
+		- Call `start`, then `post` messages from any thread.
+
+		- Call `finish` to wait till all messages posted are processed and
+		stop, `force_stop` to stop without processing messages left.
+
+		- Call `getStageStats` to read statistics of a stage.
+
+		<h3>Example</h3>
+
+		\include{lineno} pipeline_ex.cpp
+
+	*/
+	template<class In>
+	class pipeline
+	{
+	public:
+
+		/**
+			\brief The type of message posted.
+		*/
+		using info_type = In;
+
+	private:
+
+		/**
+			\brief The stages in order.
+		*/
+		std::vector<std::unique_ptr<pipeline_stage_base>> stages;
+
+		/**
+			\brief The first stage.
+		*/
+		pipeline_input<In>* first;
+
+		/**
+			\brief The mutex to serialise posters, they share one link.
+		*/
+		std::mutex mtxPost;
+
+		/**
+			\brief true while the stages run.
+		*/
+		std::atomic<bool> isRunning;
+
+		/**
+			\brief true once no more messages are accepted.
+		*/
+		std::atomic<bool> isClosed;
+
+		template<class, class>
+		friend class pipeline_builder;
+
+		/**
+			\brief Constructs from stages built.
+		*/
+		pipeline(
+			std::vector<std::unique_ptr<pipeline_stage_base>>&& built /**< :
+							<i>in</i> : The stages.*/,
+			pipeline_input<In>* input /**< : <i>in</i> : The first stage.*/
+		) : stages(std::move(built)), first(input), isRunning(false),
+			isClosed(false) {}
+
+		/**
+			\brief Waits for the workers of all stages to exit.
+		*/
+		inline void join() noexcept
+		{
+			for (auto& i : stages)
+				i->join();
+			isRunning = false;
+		}
+
+	public:
+
+		pipeline(const pipeline&) = delete;
+
+		pipeline(pipeline&&) = delete;
+
+		pipeline& operator = (pipeline&&) = delete;
+
+		pipeline& operator = (const pipeline&) = delete;
+
+		/**
+			\brief starts the workers of all stages, a pipeline can be started
+			once.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if already started or if thread
+			allocation failed.\n
+		*/
+		tristate start() noexcept
+		{
+			O3_LIB_LOG_LINE;
+			std::lock_guard<std::mutex> lock(mtxPost);
+			if (isRunning.load() || isClosed.load())
+				return tristate::ERROR;
+			isRunning = true;
+			try
+			{
+				for (auto& i : stages)
+					i->start();
+			}
+			catch (const std::system_error&)
+			{
+				isClosed = true;
+				for (auto& i : stages)
+					i->abort();
+				join();
+				return tristate::ERROR;
+			}
+			O2_LIB_LOG_LINE;
+			return tristate::GOOD;
+		}
+
+		/**
+			\brief Posts a message to the first stage, waits while its links
+			are full.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if pipeline is not running or stopped.\n
+		*/
+		tristate post(
+			info_type Message /**< : <i>in</i> : Message need to be pushed.*/
+		)
+		{
+			std::lock_guard<std::mutex> lock(mtxPost);
+			if (!isRunning.load() || isClosed.load())
+				return tristate::ERROR;
+			auto now = std::chrono::steady_clock::now();
+			return first->push(0, pipeline_item<In>{ std::move(Message), now, now })
+				? tristate::GOOD : tristate::ERROR;
+		}
+
+		/**
+			\brief Stops accepting messages, waits till all messages posted
+			are processed by all stages then joins workers.
+		*/
+		void finish() noexcept
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtxPost);
+				if (!isRunning.load() || isClosed.load())
+					return;
+				isClosed = true;
+			}
+			first->close();
+			join();
+		}
+
+		/**
+			\brief Stops all stages without processing messages left and
+			joins workers.
+		*/
+		void force_stop() noexcept
+		{
+			if (!isRunning.load())
+				return;
+			// aborted before locking so a poster waiting for space returns.
+			for (auto& i : stages)
+				i->abort();
+			{
+				std::lock_guard<std::mutex> lock(mtxPost);
+				isClosed = true;
+			}
+			join();
+		}
+
+		/**
+			\brief Checks if the stages run.
+		*/
+		inline bool isPipelineRunning() const noexcept { return isRunning.load(); }
+
+		/**
+			\brief The number of stages including sink.
+		*/
+		inline std::size_t stageCount() const noexcept { return stages.size(); }
+
+		/**
+			\brief The number of workers of a stage.
+		*/
+		inline unsigned getStageWorkers(
+			std::size_t index /**< : <i>in</i> : The stage, less than
+							  stageCount().*/
+		) const noexcept
+		{
+			return stages[index]->workerCount();
+		}
+
+		/**
+			\brief The statistics of a stage, can be read while running.
+		*/
+		inline const stage_stats& getStageStats(
+			std::size_t index /**< : <i>in</i> : The stage, less than
+							  stageCount().*/
+		) const noexcept
+		{
+			return stages[index]->stats();
+		}
+
+		/**
+			\brief The destructor. Stops without processing messages left.
+		*/
+		~pipeline()
+		{
+			force_stop();
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,791 @@
+/** ***************************************************************************
+	\file queue_backend.enh.h
+
+	\brief The file to declare the message storage backends used by class
+	queued_process.
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+	<h3> Backend Interface </h3>
+
+	A backend stores messages of type `T` between the producers and the single
+	consumer thread of a queued_process. Every backend provides :
+
+	- `bool push(T&&)` : Called by any thread, adds the message. Returns false
+	without consuming the argument if the message could not be stored.
+
+	- `std::optional<T> pop()` : Called only by the consumer, removes the
+	oldest message. Returns empty optional if no message is available.
+
+	- `void drain(std::vector<T>&)` : Called only by the consumer, moves all
+	messages available to the end of the vector in order.
+
+	- `bool empty() const` : true if no message is stored or being stored.
+
+	- `std::size_t size() const` : The approximate number of stored messages.
+
+	- `void clear()` : Destroys all stored messages, called only by the
+	consumer or when no consumer is running.
+
+	Backends with priority lanes also provide `bool push(T&&, unsigned)` and
+	`std::size_t depth(unsigned) const` which queued_process exposes.
+
+	Backends whose push fails when full provide `static constexpr 
+	std::size_t max_size()`, the number of messages they hold.
+
+	Backends which can be popped from any thread also provide `bool discard()`
+	which destroys the message least worth keeping, used to drop the oldest
+	message when a bounded queue_process is full.
+
+	A backend policy is a type with a member alias template `queue<T>` that
+	names the backend for a message type, it is what is passed to
+	queued_process.
+
+******************************************************************************/
+
+#ifndef QUEUE_BACKEND_ENH_H
+
+#define QUEUE_BACKEND_ENH_H						queue_backend.enh.h
+
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define ENH_CPU_PAUSE()			_mm_pause()
+#else
+#define ENH_CPU_PAUSE()			std::this_thread::yield()
+#endif
+
+namespace enh
+{
+	/**
+		\brief The size assumed for a cache line, used to keep atomics
+		written by different threads apart.
+	*/
+	constexpr std::size_t cache_line_size = 64;
+
+	/**
+		\brief Tells the processor the thread is spinning, yields the thread
+		every 64 calls so the spinning thread does not starve the one it
+		waits for when they share a core.
+	*/
+	inline void cpu_relax(
+		unsigned spin /**< : <i>in</i> : The number of spins so far.*/
+	) noexcept
+	{
+		if ((spin & 63) == 63)
+			std::this_thread::yield();
+		else
+			ENH_CPU_PAUSE();
+	}
+
+	/**
+		\brief Creates a message from the arguments, uses brace initialisation
+		for aggregates like gen_instruct.
+
+		<h3>Return</h3>
+		The message, can initialise a member without a copy.\n
+	*/
+	template<class T, class... Args>
+	inline T make_message(
+		Args&&... args /**< : <i>in</i> : The arguments to constructor.*/
+	)
+	{
+		if constexpr (std::is_constructible_v<T, Args...>)
+			return T(std::forward<Args>(args)...);
+		else
+			return T{ std::forward<Args>(args)... };
+	}
+
+	/**
+		\brief Template type to check whether a backend provides discard.
+
+		<h3>Template Parameter</h3>
+		-#  <code>Q</code> : The backend type to check.
+
+		<h3>Values </h3>
+		<code>true</code> if `Q::discard()` can be called.\n
+		false for all else.\n
+	*/
+	template<class Q, class = void>
+	constexpr bool canDiscard_v = false;
+
+	template<class Q>
+	constexpr bool canDiscard_v<Q, std::void_t<decltype(std::declval<Q&>().discard())>> = true;
+
+	/**
+		\brief Template type to find the size a full backend is drained to
+		before producers waiting for space in it are woken.
+
+		<h3>Template Parameter</h3>
+		-#  <code>Q</code> : The backend type to check.
+
+		<h3>Values </h3>
+		Half of `Q::max_size()` if Q provides it.\n
+		0 for all else, such backends are never full.\n
+	*/
+	template<class Q, class = void>
+	constexpr std::size_t fullWakeLevel_v = 0;
+
+	template<class Q>
+	constexpr std::size_t fullWakeLevel_v<Q, std::void_t<decltype(Q::max_size())>> = 
+		Q::max_size() / 2;
+
+	/**
+		\brief The unbounded backend which guards a std::deque with a mutex.
+
+		hasErrorHandlers        = false;\n
+
+		Every push and pop acquires the mutex, push never fails. drain swaps
+		the whole queue out under a single lock.
+
+		<h3>Template arguments</h3>
+		-#  <code>class T</code> : The type of message stored.\n
+	*/
+	template<class T>
+	class locked_queue
+	{
+	public:
+
+		/**
+			\brief The type of message stored.
+		*/
+		using value_type = T;
+
+	private:
+
+		/**
+			\brief The synchronising mutex for Queue.
+		*/
+		mutable std::mutex mtxQueue;
+
+		/**
+			\brief The Queue of messages.
+		*/
+		std::deque<value_type> QueuedMessage;
+
+		/**
+			\brief The queue swapped out by drain, only used by consumer,
+			kept to reuse its storage.
+		*/
+		std::deque<value_type> Draining;
+
+	public:
+
+		/**
+			\brief Adds message to the end of the queue.
+
+			<h3>Return</h3>
+			Always true.\n
+		*/
+		inline bool push(
+			value_type&& Message /**< : <i>in</i> : Message to be added.*/
+		)
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			QueuedMessage.push_back(std::move(Message));
+			return true;
+		}
+
+		/**
+			\brief Removes the message at the front of the queue.
+
+			<h3>Return</h3>
+			The message removed, or empty if queue was empty.\n
+		*/
+		inline std::optional<value_type> pop()
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			if (QueuedMessage.empty())
+				return std::nullopt;
+			std::optional<value_type> ret(std::move(QueuedMessage.front()));
+			QueuedMessage.pop_front();
+			return ret;
+		}
+
+		/**
+			\brief Destroys the message at the front of the queue.
+
+			<h3>Return</h3>
+			false if queue was empty.\n
+		*/
+		inline bool discard()
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			if (QueuedMessage.empty())
+				return false;
+			QueuedMessage.pop_front();
+			return true;
+		}
+
+		/**
+			\brief Moves all messages in queue to the end of out.
+		*/
+		void drain(
+			std::vector<value_type>& out /**< : <i>out</i> : The messages
+										 removed.*/
+		)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtxQueue);
+				Draining.swap(QueuedMessage);
+			}
+			out.reserve(out.size() + Draining.size());
+			for (auto& i : Draining)
+				out.push_back(std::move(i));
+			Draining.clear();
+		}
+
+		/**
+			\brief Checks if queue is empty.
+		*/
+		inline bool empty() const noexcept
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			return QueuedMessage.empty();
+		}
+
+		/**
+			\brief The number of messages in queue.
+		*/
+		inline std::size_t size() const noexcept
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			return QueuedMessage.size();
+		}
+
+		/**
+			\brief Destroys all messages in queue.
+		*/
+		inline void clear() noexcept
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			QueuedMessage.clear();
+		}
+	};
+
+	/**
+		\brief The bounded lock-free backend for many producers and a single
+		consumer.
+
+		hasErrorHandlers        = false;\n
+
+		The messages are stored in a ring of preallocated cells, each with a
+		sequence number that tells whether it is free for the producer holding
+		a ticket for it or is ready for the consumer. Producers claim tickets
+		by a compare and exchange, so no producer ever waits on a lock and no
+		memory is allocated after construction.
+
+		push fails if the ring is full.
+
+		<h3>Template arguments</h3>
+		-#  <code>class T</code> : The type of message stored.\n
+		-#  <code>std::size_t capacity</code> : The number of cells, must be
+		a power of 2.\n
+	*/
+	template<class T, std::size_t capacity>
+	class mpsc_ring
+	{
+	public:
+
+		/**
+			\brief The type of message stored.
+		*/
+		using value_type = T;
+
+	private:
+
+		static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0,
+			"ring capacity must be a power of 2");
+
+		static_assert(std::is_nothrow_move_constructible_v<value_type>,
+			"ring messages are moved into claimed cells, the move must not throw");
+
+		/**
+			\brief The mask to convert ticket to cell index.
+		*/
+		static constexpr std::size_t mask = capacity - 1;
+
+		/**
+			\brief A single slot of the ring.
+		*/
+		struct cell
+		{
+			/**
+				\brief equals ticket if cell is free for producer holding
+				ticket, ticket + 1 if message is ready for the consumer.
+			*/
+			std::atomic<std::size_t> sequence;
+
+			/**
+				\brief The storage of the message.
+			*/
+			alignas(value_type) unsigned char storage[sizeof(value_type)];
+		};
+
+		/**
+			\brief The cells of the ring.
+		*/
+		std::unique_ptr<cell[]> buffer;
+
+		/**
+			\brief The next ticket to be claimed by a producer.
+		*/
+		alignas(cache_line_size) std::atomic<std::size_t> enqueue_pos;
+
+		/**
+			\brief The next ticket to be read by the consumer.
+		*/
+		alignas(cache_line_size) std::atomic<std::size_t> dequeue_pos;
+
+	public:
+
+		/**
+			\brief Allocates all cells of the ring.
+		*/
+		mpsc_ring() : buffer(new cell[capacity])
+		{
+			for (std::size_t i = 0; i < capacity; ++i)
+				buffer[i].sequence.store(i, std::memory_order_relaxed);
+			enqueue_pos.store(0, std::memory_order_relaxed);
+			dequeue_pos.store(0, std::memory_order_relaxed);
+		}
+
+		mpsc_ring(const mpsc_ring&) = delete;
+
+		mpsc_ring& operator = (const mpsc_ring&) = delete;
+
+		/**
+			\brief Destroys messages left in ring.
+		*/
+		~mpsc_ring()
+		{
+			clear();
+		}
+
+		/**
+			\brief Adds message to the end of the ring.
+
+			The cell is claimed before the message is moved in, the move must
+			not throw.
+
+			<h3>Return</h3>
+			false if ring is full, Message is left untouched.\n
+		*/
+		bool push(
+			value_type&& Message /**< : <i>in</i> : Message to be added.*/
+		)
+		{
+			std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+			cell* target = nullptr;
+			while (true)
+			{
+				target = &buffer[pos & mask];
+				std::size_t seq = target->sequence.load(std::memory_order_acquire);
+				std::intptr_t diff = static_cast<std::intptr_t>(seq) -
+					static_cast<std::intptr_t>(pos);
+				if (diff == 0)
+				{
+					if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+						std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false;
+				else
+					pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+			new (target->storage) value_type(std::move(Message));
+			target->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+			\brief Removes the message at the front of the ring, consumer only.
+
+			<h3>Return</h3>
+			The message removed, or empty if no message is ready.\n
+		*/
+		std::optional<value_type> pop()
+		{
+			std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+			cell* target = &buffer[pos & mask];
+			if (target->sequence.load(std::memory_order_acquire) != pos + 1)
+				return std::nullopt;
+			value_type* item = std::launder(
+				reinterpret_cast<value_type*>(target->storage));
+			std::optional<value_type> ret(std::move(*item));
+			item->~value_type();
+			target->sequence.store(pos + capacity, std::memory_order_release);
+			dequeue_pos.store(pos + 1, std::memory_order_release);
+			return ret;
+		}
+
+		/**
+			\brief Moves all ready messages to the end of out, consumer only.
+		*/
+		void drain(
+			std::vector<value_type>& out /**< : <i>out</i> : The messages
+										 removed.*/
+		)
+		{
+			while (auto front = pop())
+				out.push_back(std::move(*front));
+		}
+
+		/**
+			\brief Checks if ring is empty, messages being written by a
+			producer are counted.
+		*/
+		inline bool empty() const noexcept
+		{
+			return size() == 0;
+		}
+
+		/**
+			\brief The number of messages the ring can hold.
+		*/
+		static constexpr std::size_t max_size() noexcept
+		{
+			return capacity;
+		}
+
+		/**
+			\brief The approximate number of messages in ring.
+		*/
+		inline std::size_t size() const noexcept
+		{
+			std::size_t head = dequeue_pos.load(std::memory_order_acquire);
+			std::size_t tail = enqueue_pos.load(std::memory_order_acquire);
+			return (tail > head) ? (tail - head) : 0;
+		}
+
+		/**
+			\brief Destroys all ready messages in ring, consumer only.
+		*/
+		inline void clear() noexcept
+		{
+			while (pop())
+				;
+		}
+	};
+
+	/**
+		\brief The backend with a fixed number of FIFO lanes, the message from
+		the highest priority lane is removed first.
+
+		hasErrorHandlers        = false;\n
+
+		Lane 0 has the highest priority. Messages pushed without a lane go to
+		the lowest priority lane (lanes - 1).
+
+		To prevent starvation, a lane which has messages but was passed over
+		for starvation_limit consecutive pops is served next even if a higher
+		priority lane has messages.
+
+		The depth of each lane is kept in an atomic and can be read without
+		locking.
+
+		<h3>Template arguments</h3>
+		-#  <code>class T</code> : The type of message stored.\n
+		-#  <code>unsigned lanes</code> : The number of priority lanes.\n
+		-#  <code>unsigned starvation_limit</code> : The number of pops a 
+		waiting lane can be passed over.\n
+	*/
+	template<class T, unsigned lanes, unsigned starvation_limit>
+	class lane_queue
+	{
+	public:
+
+		/**
+			\brief The type of message stored.
+		*/
+		using value_type = T;
+
+		/**
+			\brief The number of lanes.
+		*/
+		static constexpr unsigned lane_count = lanes;
+
+	private:
+
+		static_assert(lanes >= 1, "there must be at least one lane");
+		static_assert(starvation_limit >= 1, "starvation limit must be positive");
+
+		/**
+			\brief The synchronising mutex for all lanes.
+		*/
+		mutable std::mutex mtxQueue;
+
+		/**
+			\brief The Queue of messages for each lane.
+		*/
+		std::array<std::deque<value_type>, lanes> Lanes;
+
+		/**
+			\brief The number of consecutive pops each lane was passed over
+			while it had messages.
+		*/
+		std::array<unsigned, lanes> skipped;
+
+		/**
+			\brief The number of messages in each lane.
+		*/
+		std::array<std::atomic<std::size_t>, lanes> lane_depth;
+
+		/**
+			\brief The lane to use for an out of range lane.
+		*/
+		static constexpr unsigned valid_lane(
+			unsigned lane /**< : <i>in</i> : The lane requested.*/
+		) noexcept
+		{
+			return (lane < lanes) ? lane : (lanes - 1);
+		}
+
+	public:
+
+		/**
+			\brief Constructs all lanes empty.
+		*/
+		lane_queue() noexcept
+		{
+			for (unsigned i = 0; i < lanes; ++i)
+			{
+				skipped[i] = 0;
+				lane_depth[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+			\brief Adds message to the end of the lowest priority lane.
+
+			<h3>Return</h3>
+			Always true.\n
+		*/
+		inline bool push(
+			value_type&& Message /**< : <i>in</i> : Message to be added.*/
+		)
+		{
+			return push(std::move(Message), lanes - 1);
+		}
+
+		/**
+			\brief Adds message to the end of a lane, out of range lanes are
+			taken as the lowest priority lane.
+
+			<h3>Return</h3>
+			Always true.\n
+		*/
+		inline bool push(
+			value_type&& Message /**< : <i>in</i> : Message to be added.*/,
+			unsigned lane /**< : <i>in</i> : The lane, 0 is highest priority.*/
+		)
+		{
+			lane = valid_lane(lane);
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			Lanes[lane].push_back(std::move(Message));
+			lane_depth[lane].fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		/**
+			\brief Removes the message at the front of the highest priority
+			lane which has messages, or of a starving lane.
+
+			<h3>Return</h3>
+			The message removed, or empty if all lanes are empty.\n
+		*/
+		std::optional<value_type> pop()
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			unsigned chosen = lanes;
+			for (unsigned i = 0; i < lanes; ++i)
+			{
+				if (Lanes[i].empty())
+					continue;
+				if (chosen == lanes)
+					chosen = i;
+				else if (skipped[i] >= starvation_limit)
+				{
+					chosen = i;
+					break;
+				}
+			}
+			if (chosen == lanes)
+				return std::nullopt;
+			for (unsigned i = 0; i < lanes; ++i)
+			{
+				if (i == chosen || Lanes[i].empty())
+					skipped[i] = 0;
+				else
+					++skipped[i];
+			}
+			std::optional<value_type> ret(std::move(Lanes[chosen].front()));
+			Lanes[chosen].pop_front();
+			lane_depth[chosen].fetch_sub(1, std::memory_order_relaxed);
+			return ret;
+		}
+
+		/**
+			\brief Destroys the message at the front of the lowest priority
+			lane which has messages.
+
+			<h3>Return</h3>
+			false if all lanes were empty.\n
+		*/
+		bool discard()
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			for (unsigned i = lanes; i > 0; --i)
+			{
+				if (Lanes[i - 1].empty())
+					continue;
+				Lanes[i - 1].pop_front();
+				lane_depth[i - 1].fetch_sub(1, std::memory_order_relaxed);
+				if (Lanes[i - 1].empty())
+					skipped[i - 1] = 0;
+				return true;
+			}
+			return false;
+		}
+
+		/**
+			\brief Moves all messages to the end of out, highest priority
+			lane first.
+		*/
+		void drain(
+			std::vector<value_type>& out /**< : <i>out</i> : The messages
+										 removed.*/
+		)
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			for (unsigned i = 0; i < lanes; ++i)
+			{
+				for (auto& j : Lanes[i])
+					out.push_back(std::move(j));
+				Lanes[i].clear();
+				skipped[i] = 0;
+				lane_depth[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+			\brief The number of messages in a lane, read without locking.
+		*/
+		inline std::size_t depth(
+			unsigned lane /**< : <i>in</i> : The lane.*/
+		) const noexcept
+		{
+			return lane_depth[valid_lane(lane)].load(std::memory_order_relaxed);
+		}
+
+		/**
+			\brief Checks if all lanes are empty.
+		*/
+		inline bool empty() const noexcept
+		{
+			return size() == 0;
+		}
+
+		/**
+			\brief The number of messages in all lanes.
+		*/
+		inline std::size_t size() const noexcept
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			std::size_t ret = 0;
+			for (auto& i : Lanes)
+				ret += i.size();
+			return ret;
+		}
+
+		/**
+			\brief Destroys all messages in all lanes.
+		*/
+		inline void clear() noexcept
+		{
+			std::lock_guard<std::mutex> lock(mtxQueue);
+			for (unsigned i = 0; i < lanes; ++i)
+			{
+				Lanes[i].clear();
+				skipped[i] = 0;
+				lane_depth[i].store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	/**
+		\brief The backend policy to use locked_queue (default).
+	*/
+	struct locked_backend
+	{
+		template<class T>
+		using queue = locked_queue<T>;
+	};
+
+	/**
+		\brief The backend policy to use mpsc_ring.
+
+		Producers finding the ring full sleep till the worker drains it to
+		half, so a ring that often fills trades throughput for memory. Size
+		it to hold the messages posted during the longest run of the
+		handler, the default suits handlers of a few microseconds.
+
+		<h3>Template arguments</h3>
+		-#  <code>std::size_t capacity</code> : The number of messages the ring
+		can hold, must be a power of 2.\n
+	*/
+	template<std::size_t capacity = 1024>
+	struct ring_backend
+	{
+		template<class T>
+		using queue = mpsc_ring<T, capacity>;
+	};
+
+	/**
+		\brief The backend policy to use lane_queue.
+
+		<h3>Template arguments</h3>
+		-#  <code>unsigned lanes</code> : The number of priority lanes.\n
+		-#  <code>unsigned starvation_limit</code> : The number of pops a
+		waiting lane can be passed over.\n
+	*/
+	template<unsigned lanes = 2, unsigned starvation_limit = 64>
+	struct priority_backend
+	{
+		template<class T>
+		using queue = lane_queue<T, lanes, starvation_limit>;
+	};
+}
+
+#endif
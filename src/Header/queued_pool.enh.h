@@ -0,0 +1,491 @@
+/** ***************************************************************************
+	\file queued_pool.enh.h
+
+	\brief The file to declare class queued_pool
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+******************************************************************************/
+
+#ifndef QUEUED_POOL_ENH_H
+
+#define QUEUED_POOL_ENH_H						queued_pool.enh.h
+
+#include "queued_process.enh.h"
+
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <type_traits>
+
+namespace enh
+{
+
+	/**
+		\brief The class to execute instructions concurrently on multiple
+		worker threads after fetching them through queues.
+
+
+		hasErrorHandlers        = false;\n
+
+		The drop in replacement of queued_process for handlers that can run in
+		parallel. Messages are distributed round robin to a queue owned by each
+		worker. A worker takes messages from the front of its own queue and
+		when it is empty, steals from the back of the queues of other workers.
+		Messages are not processed in the order they are posted.
+
+		If the processing function returns an error, only that worker stops,
+		the messages in its queue are taken by the other workers.
+
+		The function RegisterProc must be called to setup the processing function
+		before starting the queue process.\n\n
+
+		<h3>Template arguments</h3>
+		-#  <code>class instruct</code> : The type to store the instruction.\n
+
+
+		<h3> How To Use </h3>
+
+		- Use as queued_process, the processing function must be safe to be
+		called from multiple threads simultaneously.
+
+		- Pass the number of workers to the constructor, default is the
+		number of hardware threads.
+
+		<h3>Example</h3>
+
+		\include{lineno} queued_pool_ex.cpp
+
+	*/
+	template< class instruct>
+	class queued_pool
+	{
+	public:
+
+		/**
+			\brief The type of object to be processed
+		*/
+		using info_type = instruct;
+
+		/**
+			\brief The function type that processes the infomation passed.
+		*/
+		using processing_method = std::function<tristate(info_type&&)>;
+
+	private:
+
+		/**
+			\brief The queue owned by a single worker.
+		*/
+		struct alignas(cache_line_size) worker_queue
+		{
+			/**
+				\brief The synchronising mutex for the queue.
+			*/
+			std::mutex mtxQueue;
+
+			/**
+				\brief The messages distributed to the worker.
+			*/
+			std::deque<info_type> QueuedMessage;
+		};
+
+		/**
+			\brief The number of worker threads.
+		*/
+		unsigned worker_count;
+
+		/**
+			\brief The queue for each worker.
+		*/
+		std::unique_ptr<worker_queue[]> queues;
+
+		/**
+			\brief The thread handles of workers.
+		*/
+		std::vector<std::thread> workers;
+
+		/**
+			\brief The number of messages in all queues.
+		*/
+		std::atomic<std::size_t> pending;
+
+		/**
+			\brief The number of messages posted, used to pick the queue.
+		*/
+		std::atomic<std::size_t> next_queue;
+
+		/**
+			\brief The number of workers waiting for messages.
+		*/
+		std::atomic<unsigned> sleeping;
+
+		/**
+			\brief The mutex workers sleep on while waiting for messages.
+		*/
+		std::mutex mtxPool;
+
+		/**
+			\brief The object to notify update to queues.
+		*/
+		std::condition_variable cvPool;
+
+		/**
+			\brief The bool variable which signals the workers to stop and
+			exit after the current message.
+		*/
+		std::atomic<bool> QueueStop;
+
+		/**
+			\brief sets to true if workers are active.
+		*/
+		std::atomic<bool> isQueueActive;
+
+		/**
+			\brief The function which processes the instruction then.
+		*/
+		processing_method msgProc;
+
+
+		/**
+			\brief Takes the next message for worker, first from its own queue
+			then from the others.
+
+			<h3>Return</h3>
+			The message, empty if all queues are empty.\n
+		*/
+		std::optional<info_type> take(
+			unsigned index /**< : <i>in</i> : The index of worker.*/
+		)
+		{
+			{
+				worker_queue& own = queues[index];
+				std::lock_guard<std::mutex> lock(own.mtxQueue);
+				if (!own.QueuedMessage.empty())
+				{
+					std::optional<info_type> ret(std::move(own.QueuedMessage.front()));
+					own.QueuedMessage.pop_front();
+					--pending;
+					return ret;
+				}
+			}
+			for (unsigned i = 1; i < worker_count; ++i)
+			{
+				worker_queue& victim = queues[(index + i) % worker_count];
+				std::lock_guard<std::mutex> lock(victim.mtxQueue);
+				if (!victim.QueuedMessage.empty())
+				{
+					std::optional<info_type> ret(std::move(victim.QueuedMessage.back()));
+					victim.QueuedMessage.pop_back();
+					--pending;
+					return ret;
+				}
+			}
+			return std::nullopt;
+		}
+
+		/**
+			\brief loops and executes tasks from the queues until stop is
+			signalled.
+
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if msgProc fails.\n
+		*/
+		tristate worker_process(
+			unsigned index /**< : <i>in</i> : The index of worker.*/
+		) noexcept
+		{
+			O1_LIB_LOG_LINE;
+			while (!(QueueStop.load()))
+			{
+				O3_LIB_LOG_LINE;
+				std::optional<info_type> front = take(index);
+				if (front)
+				{
+					tristate ret = msgProc(std::move(*front));
+					if (!ret)
+						return (tristate::ERROR);
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(mtxPool);
+				++sleeping;
+				cvPool.wait(lock, [this]() {
+					return pending.load() > 0 || QueueStop.load();
+					});
+				--sleeping;
+			}
+			O4_LIB_LOG_LINE;
+			return (tristate::GOOD);
+		}
+
+		/**
+			\brief Clears all the queues.
+		*/
+		inline void clear() noexcept
+		{
+			for (unsigned i = 0; i < worker_count; ++i)
+			{
+				std::lock_guard<std::mutex> lock(queues[i].mtxQueue);
+				pending -= queues[i].QueuedMessage.size();
+				queues[i].QueuedMessage.clear();
+			}
+		}
+
+	public:
+
+		/**
+			\brief The default constructor.
+		*/
+		explicit queued_pool(
+			unsigned count = std::thread::hardware_concurrency() /**< :
+						<i>in</i> : The number of worker threads.*/
+		) : worker_count(count ? count : 1),
+			queues(new worker_queue[worker_count])
+		{
+			pending = 0;
+			next_queue = 0;
+			sleeping = 0;
+			QueueStop = false;
+			isQueueActive = false;
+		}
+
+		/**
+			\brief Registers the processing method while constructing.
+		*/
+		explicit queued_pool(
+			processing_method msg /**< : <i>in</i> : The procedure.*/,
+			unsigned count = std::thread::hardware_concurrency() /**< :
+						<i>in</i> : The number of worker threads.*/
+		) : queued_pool(count)
+		{
+			msgProc = msg;
+		}
+
+		queued_pool(const queued_pool&) = delete;
+
+		queued_pool(queued_pool&&) = delete;
+
+		queued_pool& operator = (queued_pool&&) = delete;
+
+		queued_pool& operator = (const queued_pool&) = delete;
+
+		/**
+			\brief The Function to set a function as the instruction processor.
+		*/
+		inline void RegisterProc(
+			processing_method in /**< : <i>in</i> : The procedure.*/
+		) noexcept
+		{
+			msgProc = in;
+		}
+
+		/**
+			\brief The number of worker threads.
+		*/
+		inline unsigned workerCount() const noexcept { return worker_count; }
+
+		/**
+			\brief starts the workers.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if no procedure was set, or workers are
+			already running or if thread allocation failed.\n
+		*/
+		tristate start_queue_process() noexcept
+		{
+			O3_LIB_LOG_LINE;
+			if (!msgProc)
+				return tristate::ERROR;
+			if (isQueueRunning())
+				return tristate::ERROR;
+			O2_LIB_LOG_LINE;
+			QueueStop = false;
+			try
+			{
+				for (unsigned i = 0; i < worker_count; ++i)
+					workers.emplace_back(&queued_pool::worker_process, this, i);
+			}
+			catch (const std::system_error&)
+			{
+				stopQueue();
+				for (auto& i : workers)
+					i.join();
+				workers.clear();
+				QueueStop = false;
+				return tristate::ERROR;
+			}
+			isQueueActive = true;
+			O2_LIB_LOG_LINE;
+			return (tristate::GOOD);
+		}
+
+		/**
+			\brief check if any queue has messages.
+		*/
+		inline bool isQueueUpdated() noexcept
+		{
+			return pending.load() > 0;
+		}
+
+		/**
+			\brief The function post a message onto the queue of the next
+			worker.
+		*/
+		inline void postMessage(
+			info_type Message /**< : <i>in</i> : Message need to be pushed.*/
+		)
+		{
+			emplaceMessage(std::move(Message));
+		}
+
+		/**
+			\brief The function constructs a message in the queue of the next
+			worker from the arguments passed.
+		*/
+		template<class... Args>
+		inline void emplaceMessage(
+			Args&&... args /**< : <i>in</i> : The arguments to construct
+						   message.*/
+		)
+		{
+			worker_queue& target = queues[next_queue++ % worker_count];
+			{
+				std::lock_guard<std::mutex> lock(target.mtxQueue);
+				if constexpr (std::is_constructible_v<info_type, Args...>)
+					target.QueuedMessage.emplace_back(std::forward<Args>(args)...);
+				else
+					target.QueuedMessage.push_back(
+						info_type{ std::forward<Args>(args)... });
+				++pending;
+			}
+			if (sleeping.load() > 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mtxPool);
+				}
+				cvPool.notify_one();
+			}
+			return;
+		}
+
+		/**
+			\brief The function to signal the workers to stop processing.
+		*/
+		inline void stopQueue() noexcept
+		{
+			QueueStop = true;
+			{
+				std::lock_guard<std::mutex> lock(mtxPool);
+			}
+			cvPool.notify_all();
+		}
+
+		/**
+			\brief Checks if workers are running.
+
+		  <h3>Return</h3>
+		  true if workers are running.\n
+
+		*/
+		inline bool isQueueRunning() noexcept { return isQueueActive.load(); };
+
+		/**
+			\brief Waits till all workers stop execution. Then empties queues.
+		*/
+		inline void WaitForQueueStop() noexcept
+		{
+			if (!workers.empty() || isQueueRunning())
+			{
+				O3_LIB_LOG_LINE;
+				for (auto& i : workers)
+					i.join();
+				workers.clear();
+				O4_LIB_LOG_LINE;
+				isQueueActive = false;
+				QueueStop = false;
+				clear();
+			}
+		}
+
+		/**
+			\brief Waits till queues are Empty then stops workers and joins.
+		*/
+		inline void safe_join(
+			std::chrono::nanoseconds ns /**< : <i>in</i> : The amount of time
+							to wait between each cecks to the queues size.*/
+		)
+		{
+			if (!isQueueRunning())
+				return;
+			WaitForQueueEmpty(ns);
+			stopQueue();
+			WaitForQueueStop();
+		}
+
+		/**
+			\brief Signals stop then waits for workers to join.
+
+			<b>Note</b> : Even if queues have messages left over, it will exit
+			and messages will be destroyed.
+		*/
+		inline void force_join()
+		{
+			if (!isQueueRunning())
+				return;
+			stopQueue();
+			WaitForQueueStop();
+		}
+
+		/**
+			\brief The function to wait till all queues are empty.
+		*/
+		inline void WaitForQueueEmpty(
+			std::chrono::nanoseconds ns /**< : <i>in</i> : The amount of time
+							to wait between each cecks to the queues size.*/
+		) noexcept
+		{
+			while (pending.load() > 0)
+			{
+				O3_LIB_LOG_LINE;
+				std::this_thread::sleep_for(ns);
+			}
+			return;
+		}
+
+		/**
+			\brief The destructor. Exits without waiting for queue stop.
+		*/
+		~queued_pool()
+		{
+			force_join();
+		}
+	};
+
+}
+
+#endif
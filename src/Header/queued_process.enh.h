@@ -29,13 +29,20 @@
 #define QUEUED_PROCESS_ENH_H						queued_process.enh.h
 
 #include "error_base.enh.h"
+#include "queue_backend.enh.h"
 
 #include <mutex>
-#include <queue>
 #include <condition_variable>
 #include <functional>
 #include <chrono>
+#include <vector>
+#include <type_traits>
 #include <new>
+#include <utility>
+
+#ifdef ENH_QUEUE_STATS
+#include "histogram.enh.h"
+#endif
 
 namespace enh
 {
@@ -72,6 +79,381 @@ namespace enh
 	*/
 	class blank_t {};
 
+	/**
+		\brief Enumeration to define what is done with a message posted to a
+		bounded queue which is full.
+	*/
+	enum class overflow_policy : char
+	{
+		BLOCK = 0 /**< : <i>0</i> : Producer waits till there is space. */,
+		FAIL = 1 /**< : <i>1</i> : Message is not posted, post returns
+				 tristate::ERROR. */,
+		DROP_OLDEST = 2 /**< : <i>2</i> : The oldest message in queue is 
+						destroyed to make space. */,
+		DROP_NEWEST = 3 /**< : <i>3</i> : The message posted is destroyed. */
+	};
+
+	/**
+		\brief Enumeration to define how the worker of queued_process waits
+		for messages.
+	*/
+	enum class wait_strategy : char
+	{
+		BLOCK = 0 /**< : <i>0</i> : Worker sleeps till a message is posted. */,
+		SPIN_THEN_PARK = 1 /**< : <i>1</i> : Worker checks for messages for a
+						   number of spins, then sleeps. */,
+		BUSY_POLL = 2 /**< : <i>2</i> : Worker never sleeps, lowest latency 
+					  but keeps a core busy. */
+	};
+
+	/**
+		\brief The structure to report how often a bounded queue was full.
+	*/
+	struct overflow_stats
+	{
+		unsigned long long blocked; /**< \brief Posts that had to wait.*/
+		unsigned long long timed_out; /**< \brief Posts that gave up waiting.*/
+		unsigned long long rejected; /**< \brief Posts refused by FAIL.*/
+		unsigned long long dropped_oldest; /**< \brief Messages destroyed by 
+										   DROP_OLDEST.*/
+		unsigned long long dropped_newest; /**< \brief Messages destroyed by 
+										   DROP_NEWEST.*/
+	};
+
+#ifdef ENH_QUEUE_STATS
+
+	/**
+		\brief The structure of instrumentation kept by queued_process if
+		ENH_QUEUE_STATS is defined.
+
+		All members can be read from any thread without locking while the
+		queue is running. Durations are recorded in nanoseconds.
+	*/
+	struct queue_stats
+	{
+		std::atomic<long long> depth; /**< \brief Messages queued.*/
+		std::atomic<long long> peak_depth; /**< \brief The largest depth
+										   reached.*/
+		std::atomic<unsigned long long> enqueued; /**< \brief Messages
+												  queued.*/
+		std::atomic<unsigned long long> processed; /**< \brief Messages
+												   passed to the handler.*/
+		std::atomic<unsigned long long> failed; /**< \brief Handler calls
+												which did not return
+												tristate::GOOD.*/
+		latency_histogram<> wait_time; /**< \brief Time from post till the
+									   worker takes the message.*/
+		latency_histogram<> handler_time; /**< \brief Time taken by each
+										  handler call, a batch is one call.*/
+		std::atomic<unsigned long long> parked; /**< \brief Times the worker
+												slept waiting for messages.*/
+		std::atomic<unsigned long long> notified; /**< \brief Times a 
+												  producer woke the worker.*/
+
+		queue_stats() noexcept : depth(0), peak_depth(0), enqueued(0),
+			processed(0), failed(0), parked(0), notified(0) {}
+	};
+
+#endif
+
+	template<class instruct, class backend, class handler>
+	class queued_process;
+
+	/**
+		\brief The class to wait for the result of processing a message posted
+		by queued_process::postForResult.
+
+
+		hasErrorHandlers        = false;\n
+
+		The object is returned by postForResult and stays where it was 
+		returned to, it cannot be copied or moved and needs no allocation. 
+		It completes with the value returned by the handler or with 
+		tristate::ERROR if the message was refused, dropped or destroyed
+		without being processed.
+
+		<b>Note</b> : The destructor does not wait, a message whose result is
+		destroyed first is still processed but completes nothing.
+	*/
+	class post_result
+	{
+		/**
+			\brief The synchronising mutex for the result.
+		*/
+		mutable std::mutex mtxResult;
+
+		/**
+			\brief The object to notify completion.
+		*/
+		mutable std::condition_variable cvResult;
+
+		/**
+			\brief true once the result is set.
+		*/
+		std::atomic<bool> isReady;
+
+		/**
+			\brief The value returned by the handler.
+		*/
+		tristate value;
+
+		/**
+			\brief The result pointer of the queued message carrying this
+			object, null once completed or if not queued. Guarded by 
+			link_lock(this).
+		*/
+		std::atomic<post_result*>* link;
+
+		template<class instruct, class backend, class handler>
+		friend class queued_process;
+
+		template<class T>
+		friend struct queued_item;
+
+		/**
+			\brief Posts the message through the function passed, completes
+			with tristate::ERROR if it was not queued.
+		*/
+		template<class post_fn>
+		explicit post_result(
+			post_fn&& post /**< : <i>in</i> : Queues the message carrying this
+						   object, returns false if it was not queued.*/
+		) : isReady(false), value(tristate::ERROR), link(nullptr)
+		{
+			if (!post(this))
+				complete(tristate::ERROR);
+		}
+
+		/**
+			\brief Sets the result and wakes the waiting threads.
+		*/
+		inline void complete(
+			tristate ret /**< : <i>in</i> : The result.*/
+		) noexcept
+		{
+			std::lock_guard<std::mutex> lock(mtxResult);
+			value = ret;
+			isReady.store(true);
+			cvResult.notify_all();
+		}
+
+		/**
+			\brief The lock guarding the link between a result and its 
+			message, shared by results whose addresses hash alike.
+
+			The locks outlive every result so a message can lock the one of a
+			result being destroyed and find it detached.
+
+			<h3>Return</h3>
+			The lock for the result.\n
+		*/
+		static std::mutex& link_lock(
+			const post_result* result /**< : <i>in</i> : The result.*/
+		) noexcept
+		{
+			static std::mutex locks[64];
+			return locks[(reinterpret_cast<std::uintptr_t>(result) / 
+				alignof(post_result)) % 64];
+		}
+
+		/**
+			\brief Checks for the result for a short while before sleeping,
+			results of short handlers are often ready by then.
+		*/
+		inline void spin() const noexcept
+		{
+			for (unsigned i = 0; i < 256 && !isReady.load(); ++i)
+				cpu_relax(i);
+		}
+
+	public:
+
+		post_result(const post_result&) = delete;
+
+		post_result(post_result&&) = delete;
+
+		post_result& operator = (post_result&&) = delete;
+
+		post_result& operator = (const post_result&) = delete;
+
+		/**
+			\brief Checks if the result is complete without waiting.
+		*/
+		inline bool ready() const noexcept { return isReady.load(); }
+
+		/**
+			\brief Waits till the result is complete.
+		*/
+		inline void wait() const
+		{
+			spin();
+			std::unique_lock<std::mutex> lock(mtxResult);
+			cvResult.wait(lock, [this]() { return isReady.load(); });
+		}
+
+		/**
+			\brief Waits at most timeout for the result.
+
+			<h3>Return</h3>
+			true if result is complete.\n
+		*/
+		template<class Rep, class Period>
+		inline bool wait_for(
+			std::chrono::duration<Rep, Period> timeout /**< : <i>in</i> : The
+							maximum time to wait.*/
+		) const
+		{
+			std::unique_lock<std::mutex> lock(mtxResult);
+			return cvResult.wait_for(lock, timeout, [this]() {
+				return isReady.load();
+				});
+		}
+
+		/**
+			\brief Waits till the result is complete.
+
+			<h3>Return</h3>
+			The value returned by handler, tristate::ERROR if message was not 
+			processed.\n
+		*/
+		inline tristate get() const
+		{
+			spin();
+			std::unique_lock<std::mutex> lock(mtxResult);
+			cvResult.wait(lock, [this]() { return isReady.load(); });
+			return value;
+		}
+
+		/**
+			\brief The destructor, detaches from the message if it is still
+			queued so that processing it completes nothing.
+		*/
+		~post_result()
+		{
+			std::lock_guard<std::mutex> lock(link_lock(this));
+			if (link)
+				link->store(nullptr, std::memory_order_relaxed);
+		}
+	};
+
+	/**
+		\brief The structure stored in the backend of queued_process for each
+		message, it carries the bookkeeping of the message along with it.
+
+		A message which carries a post_result completes it with 
+		tristate::ERROR if destroyed before being processed.
+	*/
+	template<class T>
+	struct queued_item
+	{
+		/**
+			\brief The message.
+		*/
+		T msg;
+
+		/**
+			\brief The result to complete once processed, null if none or
+			if the result was destroyed. Changed only under 
+			post_result::link_lock of the result.
+		*/
+		std::atomic<post_result*> result;
+
+#ifdef ENH_QUEUE_STATS
+		/**
+			\brief The time message was posted.
+		*/
+		std::chrono::steady_clock::time_point posted;
+#endif
+
+		/**
+			\brief Constructs the message from the arguments.
+		*/
+		template<class... Args>
+		explicit queued_item(
+			std::in_place_t /**< : <i>in</i> : Tag to construct in place.*/,
+			Args&&... args /**< : <i>in</i> : The arguments to construct
+						   message.*/
+		) : msg(make_message<T>(std::forward<Args>(args)...)), result(nullptr)
+#ifdef ENH_QUEUE_STATS
+			, posted(std::chrono::steady_clock::now())
+#endif
+		{}
+
+		/**
+			\brief Constructs the message from the arguments, carrying the 
+			result to complete.
+		*/
+		template<class... Args>
+		explicit queued_item(
+			post_result* done /**< : <i>in</i> : The result to complete.*/,
+			std::in_place_t /**< : <i>in</i> : Tag to construct in place.*/,
+			Args&&... args /**< : <i>in</i> : The arguments to construct
+						   message.*/
+		) : msg(make_message<T>(std::forward<Args>(args)...)), result(done)
+#ifdef ENH_QUEUE_STATS
+			, posted(std::chrono::steady_clock::now())
+#endif
+		{
+			std::lock_guard<std::mutex> lock(post_result::link_lock(done));
+			done->link = &result;
+		}
+
+		/**
+			\brief The move constructor, the result moves with the message.
+		*/
+		queued_item(
+			queued_item&& other /**< : <i>in</i> : The item moved from.*/
+		) noexcept(std::is_nothrow_move_constructible_v<T>) 
+			: msg(std::move(other.msg)), result(nullptr)
+#ifdef ENH_QUEUE_STATS
+			, posted(other.posted)
+#endif
+		{
+			post_result* done = other.result.load(std::memory_order_acquire);
+			if (!done)
+				return;
+			std::lock_guard<std::mutex> lock(post_result::link_lock(done));
+			if (other.result.load(std::memory_order_relaxed) != done)
+				return;
+			other.result.store(nullptr, std::memory_order_relaxed);
+			result.store(done, std::memory_order_relaxed);
+			done->link = &result;
+		}
+
+		queued_item(const queued_item&) = delete;
+
+		queued_item& operator = (const queued_item&) = delete;
+
+		queued_item& operator = (queued_item&&) = delete;
+
+		/**
+			\brief Completes the result carried, if any.
+		*/
+		inline void complete(
+			tristate ret /**< : <i>in</i> : The value returned by handler.*/
+		) noexcept
+		{
+			post_result* done = result.load(std::memory_order_acquire);
+			if (!done)
+				return;
+			std::lock_guard<std::mutex> lock(post_result::link_lock(done));
+			if (result.load(std::memory_order_relaxed) != done)
+				return;
+			result.store(nullptr, std::memory_order_relaxed);
+			done->link = nullptr;
+			done->complete(ret);
+		}
+
+		/**
+			\brief The destructor, completes the result carried with 
+			tristate::ERROR.
+		*/
+		~queued_item()
+		{
+			complete(tristate::ERROR);
+		}
+	};
+
 	/**
 		\brief The class to implement a structure which executes instructions
 		concurently after fetching them through a queue for final use
@@ -80,11 +462,18 @@ namespace enh
 
 		hasErrorHandlers        = false;\n
 
-		The function RegisterProc must be called to setup the processing function
-		before starting the queue process.\n\n
+		The function RegisterProc or RegisterBatchProc must be called to setup 
+		the processing function before starting the queue process.\n\n
 
 		<h3>Template arguments</h3>
 		-#  <code>class instruct</code> : The type to store the instruction.\n
+		-#  <code>class backend</code> : The backend policy which decides how
+		messages are stored, locked_backend (default), ring_backend for a
+		bounded lock-free ring or priority_backend for priority lanes, see 
+		queue_backend.enh.h.\n
+		-#  <code>class handler</code> : The type of processing function, 
+		std::function by default. Pass the type of a lambda or functor to 
+		call it directly (see inline_queued_process).\n
 
 		
 		<h3> How To Use </h3>
@@ -92,19 +481,58 @@ namespace enh
 		- Create a structure that contains information to be sequentially 
 		processed. Let it be `struct info`. You can use structures 
 		`gen_instruct` and `quad_instruct` to merge different types easily.
-		The type must be copy-constructible. Let it be `info`.
+		The type must be move-constructible. Let it be `info`.
 
 		- Create a Function of type queued_process::processing_method returns 
-		`tristate`, takes `info` as argument. The function should return 
-		something other than tristate::GOOD if a fatal error occurs. Let it 
-		be `proc`.
+		`tristate`, takes `info` as argument (by value, const reference or 
+		rvalue reference). The message is moved to it, never copied. The 
+		function should return something other than tristate::GOOD if a 
+		fatal error occurs. Let it be `proc`.
 
 		- Create object of `queued_process<info>`, construct by passing `proc`
 		 or default construct then call `Register(proc)`.
 
+		- To avoid the indirect call of std::function for each message, 
+		create `inline_queued_process<info, decltype(proc)>` passing `proc`
+		to the constructor. The handler can then be inlined into the worker
+		loop.
+
+		- To process messages in batches instead, create a function of type
+		queued_process::batch_method and call `RegisterBatchProc`. Each time 
+		the worker wakes, it takes all pending messages under a single lock 
+		and passes them together in a vector. Batch mode is used if a batch 
+		method is registered.
+
 		- Call `start_queue_process` to start waiting on messages.
 
 		- Call `postMessage` and pass the message to add message to queue.
+		If backend is bounded and full, it yields till there is space. Or 
+		call `emplaceMessage` with the arguments to construct the message.
+
+		- Call `setCapacity` before starting to bound the number of queued
+		messages and choose what to do when full. `tryPostMessage` posts 
+		and gives up waiting for space after a timeout. `getOverflowStats`
+		counts how often the bound was hit.
+
+		- With priority_backend, pass the lane as second argument to 
+		`postMessage`, lane 0 is processed first. `getLaneDepth` gives the
+		number of messages waiting in a lane.
+
+		- Define ENH_QUEUE_STATS before including to keep statistics,
+		`getStats` returns the current and peak depth, counters and 
+		histograms of wait and handler time. Nothing is kept otherwise.
+
+		- Call `setWaitStrategy` before starting to let the worker spin for a
+		while (SPIN_THEN_PARK) or always (BUSY_POLL) instead of sleeping 
+		when queue is empty, trading CPU for lower wake-up latency. 
+		Producers only notify the worker when it is asleep.
+
+		- Call `postForResult` to post a message and get a post_result, call
+		`get` on it to wait for the value returned by the handler.
+
+		- Call `flush` to wait till all messages posted before are processed,
+		`WaitForQueueEmpty` to wait till no message is queued or being 
+		processed. The worker wakes the waiting threads, nothing is polled.
 
 		- Call `stopQueue` to stop processing.
 
@@ -118,120 +546,728 @@ namespace enh
 		\include{lineno} queued_process_ex.cpp
 
 	*/
-	template< class instruct>
+	template< class instruct, class backend = locked_backend,
+		class handler = std::function<tristate(instruct&&)>>
 	class queued_process 
 	{
 	public:
 
 		/**
-			\brief The type of object to be processed
+			\brief The type of object to be processed
+		*/
+		using info_type = instruct;
+
+		/**
+			\brief The type stored in backend for each message.
+		*/
+		using item_type = queued_item<info_type>;
+
+		/**
+			\brief The type storing queued messages.
+		*/
+		using queue_type = typename backend::template queue<item_type>;
+
+		/**
+			\brief The function type that processes the infomation passed.
+		*/
+		using processing_method = handler;
+
+		/**
+			\brief The function type that processes a batch of messages in the
+			order they were posted.
+		*/
+		using batch_method = std::function<tristate(std::vector<info_type>&)>;
+
+	private:
+
+		/**
+			\brief The mutex the worker sleeps on while waiting for messages.
+		*/
+		std::mutex mtxQueue;
+
+		/**
+			\brief The Queue to pass instruction from main to instruction processor.
+		*/
+		queue_type QueuedMessage;
+
+		/**
+			\brief The object to notify update to queue.
+		*/
+		std::condition_variable cvQueue;
+
+		/**
+			\brief The bool value which indicates whether queue has been
+			updated to avoid false wake-ups.
+
+			Only the producer which sets it from false notifies the worker.
+		*/
+		std::atomic<bool> isUpdated;
+
+		/**
+			\brief The bool variable which signals the instruction processing
+			function to stop and exit after emptying the queue.
+		*/
+		std::atomic<bool> QueueStop;
+
+		/**
+			\brief sets to true if Queued instruction processor is active.
+		*/
+		std::atomic<bool> isQueueActive;
+
+		/**
+			\brief The bool value which is true while the worker may sleep on
+			cvQueue, producers do not notify otherwise.
+		*/
+		std::atomic<bool> isParked;
+
+		/**
+			\brief How the worker waits for messages.
+		*/
+		wait_strategy strategy;
+
+		/**
+			\brief The number of spins before sleeping for 
+			wait_strategy::SPIN_THEN_PARK.
+		*/
+		unsigned spin_count;
+
+		/**
+			\brief The function which processes the instruction then.
+		*/
+		processing_method msgProc;
+
+		/**
+			\brief The function which processes batches, used if set.
+		*/
+		batch_method batchProc;
+
+		/**
+			\brief The thread handle for the queue process.
+		*/
+		std::thread queue_thread;
+
+		/**
+			\brief The maximum number of queued messages, 0 if unbounded.
+		*/
+		std::size_t capacity;
+
+		/**
+			\brief What to do with a message posted when queue is full.
+		*/
+		overflow_policy policy;
+
+		/**
+			\brief The number of messages queued or being queued, only kept
+			if bounded.
+		*/
+		std::atomic<std::size_t> depth;
+
+		/**
+			\brief The mutex producers sleep on while waiting for space.
+		*/
+		std::mutex mtxSpace;
+
+		/**
+			\brief The object to notify space in queue.
+		*/
+		std::condition_variable cvSpace;
+
+		/**
+			\brief The number of producers waiting for space.
+		*/
+		std::atomic<unsigned> waitingProducers;
+
+		/**
+			\brief The number of producers waiting for a full backend to 
+			drain.
+		*/
+		std::atomic<unsigned> waitingFull;
+
+		/**
+			\brief The number of messages queued or being queued.
+		*/
+		alignas(cache_line_size) std::atomic<unsigned long long> cntPosted;
+
+		/**
+			\brief The number of queued messages processed or destroyed.
+		*/
+		alignas(cache_line_size) std::atomic<unsigned long long> cntDone;
+
+		/**
+			\brief The number of threads waiting in flush or 
+			WaitForQueueEmpty, the worker only notifies if there are any.
+		*/
+		std::atomic<unsigned> waitingFlush;
+
+		/**
+			\brief true while the worker thread runs.
+		*/
+		std::atomic<bool> isWorking;
+
+		/**
+			\brief The mutex threads waiting for messages to be done sleep on.
+		*/
+		std::mutex mtxDrain;
+
+		/**
+			\brief The object to notify messages done.
+		*/
+		std::condition_variable cvDrain;
+
+		/**
+			\brief The counters of overflow events.
+		*/
+		std::atomic<unsigned long long> cntBlocked, cntTimedOut, cntRejected,
+			cntDroppedOldest, cntDroppedNewest;
+
+#ifdef ENH_QUEUE_STATS
+		/**
+			\brief The instrumentation of the queue.
+		*/
+		queue_stats stats;
+#endif
+
+		/**
+			\brief The outcome of reserving space for a message.
+		*/
+		enum class reservation : char
+		{
+			RESERVED = 0 /**< : <i>0</i> : Message can be queued. */,
+			REFUSED = 1 /**< : <i>1</i> : Message must not be queued,
+						post fails. */,
+			DROPPED = 2 /**< : <i>2</i> : Message must not be queued, 
+						post succeeds. */
+		};
+
+
+
+		/**
+			\brief loops and executes tasks pushed into message queue until
+			EXIT_QUEUE is pushed into the queue.
+
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if any msg_switch fails.\n
+			Returns tristate::PREV_ERROR if error was flagged in any previous
+			function calls.\n
+
+		*/
+		tristate queue_exec_process() noexcept
+		{
+			O1_LIB_LOG_LINE;
+			if (!hasProc() && !batchProc)
+				return tristate::ERROR;
+			O1_LIB_LOG_LINE;
+			std::vector<info_type> batch;
+			std::vector<item_type> items;
+			while (!(QueueStop.load()))
+			{
+				O3_LIB_LOG_LINE;
+				wait_for_messages();
+				isUpdated.exchange(false);
+				tristate ret = batchProc ? process_batches(batch, items) : 
+					process_messages();
+				if (!ret)
+					return (tristate::ERROR);
+			}
+			O4_LIB_LOG_LINE;
+			return (tristate::GOOD);
+		}
+
+		/**
+			\brief Waits till a message is posted or stop is signalled, as 
+			set by the wait strategy.
+		*/
+		inline void wait_for_messages() noexcept
+		{
+			if (strategy != wait_strategy::BLOCK)
+			{
+				for (unsigned i = 0; strategy == wait_strategy::BUSY_POLL ||
+					i < spin_count; ++i)
+				{
+					if (isUpdated.load() || QueueStop.load())
+						return;
+					cpu_relax(i);
+				}
+			}
+			// a producer setting isUpdated either is seen below or sees 
+			// isParked and notifies.
+			isParked.store(true);
+			{
+				std::unique_lock<std::mutex> lock(mtxQueue);
+				if (!isUpdated.load() && !QueueStop.load())
+				{
+					count_parked();
+					cvQueue.wait(lock, [this]() {
+						return isUpdated.load() || QueueStop.load();
+						});
+				}
+			}
+			isParked.store(false);
+		}
+
+		/**
+			\brief Processes messages one at a time till queue is empty or
+			stop is signalled.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if msgProc fails.\n
+		*/
+		tristate process_messages() noexcept
+		{
+			while (!(QueueStop.load()))
+			{
+				O3_LIB_LOG_LINE;
+				std::optional<item_type> front = QueuedMessage.pop();
+				if (!front)
+					break;
+				release(1);
+				count_taken(*front);
+				auto start = stamp();
+				tristate ret = msgProc(std::move(front->msg));
+				count_handled(start, 1, ret);
+				front->complete(ret);
+				front.reset();
+				finish(1);
+				if (!ret)
+					return (tristate::ERROR);
+			}
+			return (tristate::GOOD);
+		}
+
+		/**
+			\brief Drains the queue and passes the messages as a batch till 
+			queue is empty or stop is signalled.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if batchProc fails.\n
+		*/
+		tristate process_batches(
+			std::vector<info_type>& batch /**< : <i>inout</i> : The buffer 
+										  reused for each batch.*/,
+			std::vector<item_type>& items /**< : <i>inout</i> : The buffer
+										  reused to drain backend.*/
+		) noexcept
+		{
+			while (!(QueueStop.load()))
+			{
+				O3_LIB_LOG_LINE;
+				batch.clear();
+				items.clear();
+				QueuedMessage.drain(items);
+				if (items.empty())
+					break;
+				release(items.size());
+				for (auto& i : items)
+				{
+					count_taken(i);
+					batch.push_back(std::move(i.msg));
+				}
+				auto start = stamp();
+				tristate ret = batchProc(batch);
+				count_handled(start, batch.size(), ret);
+				for (auto& i : items)
+					i.complete(ret);
+				std::size_t count = items.size();
+				batch.clear();
+				items.clear();
+				finish(count);
+				if (!ret)
+					return (tristate::ERROR);
+			}
+			batch.clear();
+			items.clear();
+			return (tristate::GOOD);
+		}
+
+		/**
+			\brief Checks if a processing function is set, always true for 
+			handlers that cannot be empty.
+		*/
+		inline bool hasProc() const noexcept
+		{
+			if constexpr (std::is_constructible_v<bool, const processing_method&>)
+				return static_cast<bool>(msgProc);
+			else
+				return true;
+		}
+
+		/**
+			\brief Initialises the state shared by all constructors.
+		*/
+		inline void initialise() noexcept
+		{
+			isUpdated = false;
+			QueueStop = false;
+			isQueueActive = false;
+			isParked = false;
+			strategy = wait_strategy::BLOCK;
+			spin_count = 0;
+			capacity = 0;
+			policy = overflow_policy::BLOCK;
+			depth = 0;
+			waitingProducers = 0;
+			waitingFull = 0;
+			cntBlocked = 0;
+			cntTimedOut = 0;
+			cntRejected = 0;
+			cntDroppedOldest = 0;
+			cntDroppedNewest = 0;
+			cntPosted = 0;
+			cntDone = 0;
+			waitingFlush = 0;
+			isWorking = false;
+		}
+
+		/**
+			\brief Takes one slot of the bound if it is free.
+
+			<h3>Return</h3>
+			true if slot was taken.\n
+		*/
+		inline bool try_reserve() noexcept
+		{
+			std::size_t current = depth.load();
+			while (current < capacity)
+			{
+				if (depth.compare_exchange_weak(current, current + 1))
+					return true;
+			}
+			return false;
+		}
+
+		/**
+			\brief Reserves space for one message in a bounded queue according
+			to the overflow policy.
+
+			<h3>Return</h3>
+			Whether the message is to be queued.\n
+		*/
+		reservation reserve(
+			const std::chrono::steady_clock::time_point* deadline /**< :
+						<i>in</i> : The time to stop waiting, null to wait
+						indefinitely.*/
+		)
+		{
+			if (capacity == 0 || try_reserve())
+				return reservation::RESERVED;
+			switch (policy)
+			{
+			case overflow_policy::FAIL:
+				++cntRejected;
+				return reservation::REFUSED;
+			case overflow_policy::DROP_NEWEST:
+				++cntDroppedNewest;
+				return reservation::DROPPED;
+			case overflow_policy::DROP_OLDEST:
+				if constexpr (canDiscard_v<queue_type>)
+				{
+					while (true)
+					{
+						// the message discarded gives its slot to this one.
+						if (QueuedMessage.discard())
+						{
+							count_dropped(1);
+							finish(1);
+							++cntDroppedOldest;
+							return reservation::RESERVED;
+						}
+						if (try_reserve())
+							return reservation::RESERVED;
+					}
+				}
+				else
+					return reservation::REFUSED;
+			default:
+				break;
+			}
+			++cntBlocked;
+			std::unique_lock<std::mutex> lock(mtxSpace);
+			++waitingProducers;
+			while (!try_reserve())
+			{
+				if (!deadline)
+					cvSpace.wait(lock);
+				else if (cvSpace.wait_until(lock, *deadline) ==
+					std::cv_status::timeout)
+				{
+					if (try_reserve())
+						break;
+					--waitingProducers;
+					++cntTimedOut;
+					return reservation::REFUSED;
+				}
+			}
+			--waitingProducers;
+			return reservation::RESERVED;
+		}
+
+		/**
+			\brief Returns slots of a bounded queue and wakes producers 
+			waiting for space, in the bound or in a full backend drained to
+			the wake level.
 		*/
-		using info_type = instruct;
+		inline void release(
+			std::size_t count /**< : <i>in</i> : The number of slots.*/
+		)
+		{
+			if constexpr (fullWakeLevel_v<queue_type> != 0)
+			{
+				if (QueuedMessage.size() <= fullWakeLevel_v<queue_type>)
+				{
+					// pairs with the fence in wait_full, either the 
+					// producer sees the messages taken or it is seen 
+					// waiting here.
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (waitingFull.load() > 0)
+					{
+						{
+							std::lock_guard<std::mutex> lock(mtxSpace);
+						}
+						cvSpace.notify_all();
+					}
+				}
+			}
+			if (capacity == 0)
+				return;
+			depth -= count;
+			if (waitingProducers.load() > 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mtxSpace);
+				}
+				cvSpace.notify_all();
+			}
+		}
 
 		/**
-			\brief The function type that processes the infomation passed.
+			\brief Sleeps till the worker drains a full backend to half, 
+			producers spinning on it would take the time the worker needs 
+			when threads outnumber cores.
 		*/
-		using processing_method = std::function<tristate(info_type)>;
-
-	private:
+		void wait_full(
+			const std::chrono::steady_clock::time_point* deadline /**< :
+						<i>in</i> : The time to stop waiting, null to wait
+						indefinitely.*/
+		)
+		{
+			auto drained = [this]() {
+				return QueuedMessage.size() <= fullWakeLevel_v<queue_type>;
+			};
+			std::unique_lock<std::mutex> lock(mtxSpace);
+			++waitingFull;
+			// pairs with the fence in release.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!deadline)
+				cvSpace.wait(lock, drained);
+			else
+				cvSpace.wait_until(lock, *deadline, drained);
+			--waitingFull;
+		}
 
 		/**
-			\brief The synchronising mutex for Queue.
+			\brief Reserves space then pushes message using the function 
+			passed and wakes the worker.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if message was refused or timed out.\n
 		*/
-		std::mutex mtxQueue;
+		template<class push_fn>
+		tristate post(
+			push_fn&& push /**< : <i>in</i> : Pushes message to backend, 
+						   returns false if full.*/,
+			const std::chrono::steady_clock::time_point* deadline /**< :
+						<i>in</i> : The time to stop waiting, null to wait
+						indefinitely.*/
+		)
+		{
+			reservation slot = reserve(deadline);
+			if (slot == reservation::REFUSED)
+				return tristate::ERROR;
+			if (slot == reservation::DROPPED)
+				return tristate::GOOD;
+			++cntPosted;
+			while (!push())
+			{
+				if (deadline && std::chrono::steady_clock::now() >= *deadline)
+				{
+					release(1);
+					finish(1);
+					++cntTimedOut;
+					return tristate::ERROR;
+				}
+				wait_full(deadline);
+			}
+			count_posted();
+			notifyWorker();
+			return tristate::GOOD;
+		}
 
 		/**
-			\brief The Queue to pass instruction from main to instruction processor.
+			\brief Counts messages done and wakes threads waiting for them.
 		*/
-		std::queue<info_type> QueuedMessage;
+		inline void finish(
+			std::size_t count /**< : <i>in</i> : The number of messages.*/
+		)
+		{
+			cntDone += count;
+			if (waitingFlush.load() > 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mtxDrain);
+				}
+				cvDrain.notify_all();
+			}
+		}
 
 		/**
-			\brief The object to notify update to queue.
+			\brief Runs the worker then wakes threads waiting for messages to
+			be done, they can no longer be processed.
 		*/
-		std::condition_variable cvQueue;
+		void worker_process() noexcept
+		{
+			queue_exec_process();
+			isWorking = false;
+			{
+				std::lock_guard<std::mutex> lock(mtxDrain);
+			}
+			cvDrain.notify_all();
+		}
 
 		/**
-			\brief The bool value which indicates whether queue has been
-			updated to avoid false wake-ups.
+			\brief Waits till the number of messages done reaches the target 
+			or the worker stops.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if worker stopped before.\n
 		*/
-		std::atomic<bool> isUpdated;
+		template<class target_fn>
+		tristate wait_done(
+			target_fn&& target /**< : <i>in</i> : Returns the number of 
+							   messages to wait for.*/
+		)
+		{
+			if (cntDone.load() >= target())
+				return tristate::GOOD;
+			std::unique_lock<std::mutex> lock(mtxDrain);
+			++waitingFlush;
+			cvDrain.wait(lock, [&]() {
+				return cntDone.load() >= target() || !isWorking.load();
+				});
+			--waitingFlush;
+			return (cntDone.load() >= target()) ? tristate::GOOD : 
+				tristate::ERROR;
+		}
 
 		/**
-			\brief The bool variable which signals the instruction processing
-			function to stop and exit after emptying the queue.
+			\brief The time now if statistics are kept.
 		*/
-		std::atomic<bool> QueueStop;
+		inline std::chrono::steady_clock::time_point stamp() const noexcept
+		{
+#ifdef ENH_QUEUE_STATS
+			return std::chrono::steady_clock::now();
+#else
+			return std::chrono::steady_clock::time_point();
+#endif
+		}
 
 		/**
-			\brief sets to true if Queued instruction processor is active.
+			\brief Counts a message queued, does nothing unless ENH_QUEUE_STATS
+			is defined.
 		*/
-		std::atomic<bool> isQueueActive;
+		inline void count_posted() noexcept
+		{
+#ifdef ENH_QUEUE_STATS
+			++stats.enqueued;
+			long long now = ++stats.depth;
+			long long peak = stats.peak_depth.load(std::memory_order_relaxed);
+			while (now > peak && !stats.peak_depth.compare_exchange_weak(peak,
+				now, std::memory_order_relaxed))
+				;
+#endif
+		}
 
 		/**
-			\brief The function which processes the instruction then.
+			\brief Counts messages destroyed without being processed, does 
+			nothing unless ENH_QUEUE_STATS is defined.
 		*/
-		processing_method msgProc;
+		inline void count_dropped(
+			std::size_t count /**< : <i>in</i> : The number of messages.*/
+		) noexcept
+		{
+#ifdef ENH_QUEUE_STATS
+			stats.depth -= static_cast<long long>(count);
+#else
+			(void)count;
+#endif
+		}
 
 		/**
-			\brief The thread handle for the queue process.
+			\brief Counts a message taken by worker, does nothing unless 
+			ENH_QUEUE_STATS is defined.
 		*/
-		std::thread queue_thread;
-
-
+		inline void count_taken(
+			const item_type& item /**< : <i>in</i> : The message taken.*/
+		) noexcept
+		{
+#ifdef ENH_QUEUE_STATS
+			--stats.depth;
+			stats.wait_time.record(std::chrono::steady_clock::now() - item.posted);
+#else
+			(void)item;
+#endif
+		}
 
 		/**
-			\brief loops and executes tasks pushed into message queue until
-			EXIT_QUEUE is pushed into the queue.
-
+			\brief Counts a handler call, does nothing unless ENH_QUEUE_STATS
+			is defined.
+		*/
+		inline void count_handled(
+			std::chrono::steady_clock::time_point start /**< : <i>in</i> : The
+							time handler was called.*/,
+			std::size_t count /**< : <i>in</i> : The number of messages.*/,
+			tristate ret /**< : <i>in</i> : The value returned by handler.*/
+		) noexcept
+		{
+#ifdef ENH_QUEUE_STATS
+			stats.handler_time.record(std::chrono::steady_clock::now() - start);
+			stats.processed += count;
+			if (!ret)
+				++stats.failed;
+#else
+			(void)start;
+			(void)count;
+			(void)ret;
+#endif
+		}
 
-			<h3>Return</h3>
-			Returns tristate::ERROR if any msg_switch fails.\n
-			Returns tristate::PREV_ERROR if error was flagged in any previous
-			function calls.\n
+		/**
+			\brief Counts the worker sleeping, does nothing unless 
+			ENH_QUEUE_STATS is defined.
+		*/
+		inline void count_parked() noexcept
+		{
+#ifdef ENH_QUEUE_STATS
+			++stats.parked;
+#endif
+		}
 
+		/**
+			\brief Wakes the worker if it was not already signalled and may be
+			asleep.
 		*/
-		tristate queue_exec_process() noexcept
+		inline void notifyWorker()
 		{
-			O1_LIB_LOG_LINE;
-			if (!msgProc)
-				return tristate::ERROR;
-			O1_LIB_LOG_LINE;
-			while (!(QueueStop.load()))
+			if (!isUpdated.exchange(true) && isParked.load())
 			{
-				O3_LIB_LOG_LINE;
-				while (!(isUpdated.load()))
-				{
-					std::unique_lock<std::mutex> lock(mtxQueue);
-					cvQueue.wait(lock);
-					bool empty = QueuedMessage.empty();
-					lock.unlock();
-					if (!(isUpdated.load()) && QueueStop.load() && empty)
-						return (tristate::GOOD);
-
-				}
-				isUpdated = false;
-				bool stopNow = false;
 				{
 					std::lock_guard<std::mutex> lock(mtxQueue);
-					stopNow = QueuedMessage.empty() || QueueStop.load();
-				}
-				while (!stopNow)
-				{
-					O3_LIB_LOG_LINE;
-					mtxQueue.lock();
-					info_type front = QueuedMessage.front();
-					QueuedMessage.pop();
-					mtxQueue.unlock();
-					tristate ret = msgProc(front);
-					if (!ret)
-						return (tristate::ERROR);
-					std::lock_guard<std::mutex> temp_lock(mtxQueue);
-					stopNow = QueuedMessage.empty() || QueueStop.load();
 				}
-
+				cvQueue.notify_one();
+#ifdef ENH_QUEUE_STATS
+				++stats.notified;
+#endif
 			}
-			O4_LIB_LOG_LINE;
-			return (tristate::GOOD);
 		}
 
 	public:
@@ -241,11 +1277,9 @@ namespace enh
 		/**
 			\brief The default constructor.
 		*/
-		queued_process() noexcept : queue_thread()
+		queued_process() noexcept : msgProc(), queue_thread()
 		{
-			isUpdated = false;
-			QueueStop = false;
-			isQueueActive = false;
+			initialise();
 		}
 
 		/**
@@ -253,12 +1287,9 @@ namespace enh
 		*/
 		explicit queued_process(
 			processing_method msg /**< : <i>in</i> : The procedure.*/
-		) noexcept : queue_thread()
+		) noexcept : msgProc(std::move(msg)), queue_thread()
 		{
-			isUpdated = false;
-			QueueStop = false;
-			isQueueActive = false;
-			msgProc = msg;
+			initialise();
 		}
 
 		queued_process(const queued_process&) = delete;
@@ -279,6 +1310,86 @@ namespace enh
 			msgProc = in;
 		}
 
+		/**
+			\brief The Function to set a function as the batch processor, 
+			messages are processed in batches if set.
+		*/
+		inline void RegisterBatchProc(
+			batch_method in /**< : <i>in</i> : The procedure.*/
+		) noexcept
+		{
+			batchProc = in;
+		}
+
+		/**
+			\brief Bounds the number of queued messages, must be called while 
+			queue is not running and no message is being posted.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if queue is running or if policy is 
+			DROP_OLDEST and backend cannot discard messages.\n
+		*/
+		tristate setCapacity(
+			std::size_t max /**< : <i>in</i> : The maximum number of messages,
+							0 for unbounded.*/,
+			overflow_policy when_full = overflow_policy::BLOCK /**< : <i>in</i>
+							: What to do when full.*/
+		) noexcept
+		{
+			if (isQueueRunning())
+				return tristate::ERROR;
+			if (when_full == overflow_policy::DROP_OLDEST &&
+				!canDiscard_v<queue_type>)
+				return tristate::ERROR;
+			capacity = max;
+			policy = when_full;
+			depth = QueuedMessage.size();
+			return tristate::GOOD;
+		}
+
+		/**
+			\brief The maximum number of queued messages, 0 if unbounded.
+		*/
+		inline std::size_t getCapacity() const noexcept { return capacity; }
+
+		/**
+			\brief Sets how the worker waits for messages, must be called while
+			queue is not running.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if queue is running.\n
+		*/
+		tristate setWaitStrategy(
+			wait_strategy how /**< : <i>in</i> : The wait strategy.*/,
+			unsigned spins = 4096 /**< : <i>in</i> : The number of spins 
+								  before sleeping for SPIN_THEN_PARK.*/
+		) noexcept
+		{
+			if (isQueueRunning())
+				return tristate::ERROR;
+			strategy = how;
+			spin_count = spins;
+			return tristate::GOOD;
+		}
+
+		/**
+			\brief The counters of overflow events of bounded queue.
+		*/
+		inline overflow_stats getOverflowStats() const noexcept
+		{
+			return overflow_stats{ cntBlocked.load(), cntTimedOut.load(),
+				cntRejected.load(), cntDroppedOldest.load(),
+				cntDroppedNewest.load() };
+		}
+
+#ifdef ENH_QUEUE_STATS
+		/**
+			\brief The instrumentation of the queue, only if ENH_QUEUE_STATS
+			is defined. Can be read from any thread while queue runs.
+		*/
+		inline const queue_stats& getStats() const noexcept { return stats; }
+#endif
+
 		/**
 			\brief starts the function queue_process in another thread.
 
@@ -291,14 +1402,14 @@ namespace enh
 		tristate start_queue_process() noexcept
 		{
 			O3_LIB_LOG_LINE;
-			if (!msgProc)
+			if (!hasProc() && !batchProc)
 				return tristate::ERROR;
 			if (isQueueRunning())
 				return tristate::ERROR;
 			O2_LIB_LOG_LINE;
 			QueueStop = false;
-			queue_thread = std::thread(
-				&queued_process::queue_exec_process, this);
+			isWorking = true;
+			queue_thread = std::thread(&queued_process::worker_process, this);
 			isQueueActive = true;
 			O2_LIB_LOG_LINE;
 			return (tristate::GOOD);
@@ -318,18 +1429,126 @@ namespace enh
 
 		/**
 			\brief The function post a message onto the queue.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if queue is bounded, full and message was
+			refused.\n
 		*/
-		inline void postMessage(
+		inline tristate postMessage(
 			info_type Message /**< : <i>in</i> : Message need to be pushed.*/
 		)
 		{
-			{
-				std::lock_guard<std::mutex> lock(mtxQueue);
-				QueuedMessage.push(Message);
-				isUpdated = true;
-			}
-			cvQueue.notify_all();
-			return;
+			item_type item(std::in_place, std::move(Message));
+			return post([&]() {
+				return QueuedMessage.push(std::move(item));
+				}, nullptr);
+		}
+
+		/**
+			\brief The function post a message onto the queue, waits at most
+			timeout for space if queue is full.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if there was no space before timeout or
+			message was refused.\n
+		*/
+		inline tristate tryPostMessage(
+			info_type Message /**< : <i>in</i> : Message need to be pushed.*/,
+			std::chrono::nanoseconds timeout /**< : <i>in</i> : The maximum 
+							time to wait for space.*/
+		)
+		{
+			auto deadline = std::chrono::steady_clock::now() + timeout;
+			item_type item(std::in_place, std::move(Message));
+			return post([&]() {
+				return QueuedMessage.push(std::move(item));
+				}, &deadline);
+		}
+
+		/**
+			\brief The function post a message onto a lane of the queue, 
+			only for backends with priority lanes.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if queue is bounded, full and message was
+			refused.\n
+		*/
+		inline tristate postMessage(
+			info_type Message /**< : <i>in</i> : Message need to be pushed.*/,
+			unsigned lane /**< : <i>in</i> : The lane, 0 is the highest 
+						  priority.*/
+		)
+		{
+			item_type item(std::in_place, std::move(Message));
+			return post([&]() {
+				return QueuedMessage.push(std::move(item), lane);
+				}, nullptr);
+		}
+
+		/**
+			\brief The number of messages queued or being processed.
+		*/
+		inline unsigned long long getPendingCount() const noexcept
+		{
+			unsigned long long done = cntDone.load();
+			unsigned long long posted = cntPosted.load();
+			return (posted > done) ? posted - done : 0;
+		}
+
+		/**
+			\brief The number of messages waiting in a lane, only for backends
+			with priority lanes.
+		*/
+		inline std::size_t getLaneDepth(
+			unsigned lane /**< : <i>in</i> : The lane.*/
+		) const noexcept
+		{
+			return QueuedMessage.depth(lane);
+		}
+
+		/**
+			\brief The function constructs a message from the arguments passed
+			and posts it as postMessage.
+
+			The message is constructed once, before waiting for space, and
+			moved into the queue.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if queue is bounded, full and message was
+			refused.\n
+		*/
+		template<class... Args>
+		inline tristate emplaceMessage(
+			Args&&... args /**< : <i>in</i> : The arguments to construct
+						   message.*/
+		)
+		{
+			item_type item(std::in_place, std::forward<Args>(args)...);
+			return post([&]() {
+				return QueuedMessage.push(std::move(item));
+				}, nullptr);
+		}
+
+		/**
+			\brief The function post a message onto the queue and returns the
+			object to wait for the value returned by the handler.
+
+			<h3>Return</h3>
+			The result, completes with tristate::ERROR if message was refused
+			or dropped.\n
+		*/
+		inline post_result postForResult(
+			info_type Message /**< : <i>in</i> : Message need to be pushed.*/
+		)
+		{
+			return post_result([&](post_result* done) {
+				bool queued = false;
+				item_type item(done, std::in_place, std::move(Message));
+				post([&]() {
+					return (queued = QueuedMessage.push(std::move(item)));
+					}, nullptr);
+				return queued;
+				});
 		}
 
 
@@ -340,6 +1559,9 @@ namespace enh
 		inline void stopQueue() noexcept
 		{
 			QueueStop = true;
+			{
+				std::lock_guard<std::mutex> lock(mtxQueue);
+			}
 			cvQueue.notify_all();
 		}
 
@@ -365,8 +1587,15 @@ namespace enh
 				O4_LIB_LOG_LINE;
 				isQueueActive = false;
 				QueueStop = false;
-				std::lock_guard<std::mutex> lock(mtxQueue);
-				QueuedMessage = std::queue<instruct>();
+				count_dropped(QueuedMessage.size());
+				QueuedMessage.clear();
+				cntDone = cntPosted.load();
+				if (capacity != 0)
+					depth = QueuedMessage.size();
+				{
+					std::lock_guard<std::mutex> lock(mtxSpace);
+				}
+				cvSpace.notify_all();
 			}
 
 		}
@@ -374,18 +1603,29 @@ namespace enh
 		/**
 			\brief Waits till Queue is Empty then stops process and joins.
 		*/
-		inline void safe_join(
-			std::chrono::nanoseconds ns /**< : <i>in</i> : The amount of time
-							to wait between each cecks to the queues size.*/
-		)
+		inline void safe_join()
 		{
 			if (!isQueueRunning())
 				return;
-			WaitForQueueEmpty(ns);
+			WaitForQueueEmpty();
 			stopQueue();
 			WaitForQueueStop();
 		}
 
+		/**
+			\brief Waits till Queue is Empty then stops process and joins.
+
+			<b>Note</b> : ns is not used, the worker signals when queue is
+			empty, kept for compatibility.
+		*/
+		inline void safe_join(
+			std::chrono::nanoseconds ns /**< : <i>in</i> : Not used.*/
+		)
+		{
+			(void)ns;
+			safe_join();
+		}
+
 		/**
 			\brief Posts stop queue message then waits for thread to join.
 
@@ -400,28 +1640,44 @@ namespace enh
 			WaitForQueueStop();
 		}
 
+		/**
+			\brief The function to wait till instruction queue is empty and 
+			the message being processed is done, or the worker stops.
+		*/
+		inline void WaitForQueueEmpty()
+		{
+			O3_LIB_LOG_LINE;
+			wait_done([this]() { return cntPosted.load(); });
+		}
+
 		/**
 			\brief The function to wait till instruction queue is empty.
+
+			<b>Note</b> : ns is not used, the worker signals when queue is
+			empty, kept for compatibility.
 		*/
 		inline void WaitForQueueEmpty(
-			std::chrono::nanoseconds ns /**< : <i>in</i> : The amount of time
-							to wait between each cecks to the queues size.*/
-		) noexcept
+			std::chrono::nanoseconds ns /**< : <i>in</i> : Not used.*/
+		)
 		{
-			while (true)
-			{
-				O3_LIB_LOG_LINE;
-				std::this_thread::sleep_for(ns);
-				bool ret = false;
-				{
-					std::lock_guard<std::mutex> lock(mtxQueue);
-					ret = QueuedMessage.empty();
-				}
-				if (ret)
-					return;
-				O3_LIB_LOG_LINE;
-			}
-			return;
+			(void)ns;
+			WaitForQueueEmpty();
+		}
+
+		/**
+			\brief Waits till all messages posted before the call are 
+			processed or destroyed, messages posted later are not waited for.
+
+			With priority_backend messages are counted, not tracked, so it
+			returns once as many messages as were posted before it are done.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if worker is not running or stops before.\n
+		*/
+		inline tristate flush()
+		{
+			unsigned long long target = cntPosted.load();
+			return wait_done([target]() { return target; });
 		}
 
 		/**
@@ -433,6 +1689,20 @@ namespace enh
 		}
 	};
 
+	/**
+		\brief The queued_process which calls a handler of the type passed
+		directly instead of through std::function.
+
+		<h3>Template</h3>
+		-#  <code>class instruct</code> : The type to store the instruction.\n
+		-#  <code>class handler</code> : The type of lambda or functor which 
+		processes the messages.\n
+		-#  <code>class backend</code> : The backend policy, locked_backend 
+		by default.\n
+	*/
+	template<class instruct, class handler, class backend = locked_backend>
+	using inline_queued_process = queued_process<instruct, backend, handler>;
+
 }
 
 #endif
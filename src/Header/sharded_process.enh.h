@@ -0,0 +1,396 @@
+/** ***************************************************************************
+	\file sharded_process.enh.h
+
+	\brief The file to declare class sharded_process
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+******************************************************************************/
+
+#ifndef SHARDED_PROCESS_ENH_H
+
+#define SHARDED_PROCESS_ENH_H						sharded_process.enh.h
+
+#include "queued_process.enh.h"
+
+#include <memory>
+#include <thread>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+
+namespace enh
+{
+
+	/**
+		\brief The class to execute instructions on multiple workers while
+		keeping messages of the same key in the order they were posted.
+
+
+		hasErrorHandlers        = false;\n
+
+		The key of each message is extracted by the key function and hashed
+		to one of a fixed number of shards. Each shard is a queued_process
+		with its own worker, so messages of one key are processed in order
+		by one thread while different keys are processed in parallel.
+
+		The shard count is fixed at construction, a key always maps to the
+		same shard. If the processing function returns an error, only the
+		worker of that shard stops.
+
+		<h3>Template arguments</h3>
+		-#  <code>class instruct</code> : The type to store the instruction.\n
+		-#  <code>class key_fn</code> : The type of function that takes
+		`const instruct&` and returns the key, the key must be hashable by
+		std::hash.\n
+		-#  <code>class backend</code> : The backend policy of each shard,
+		locked_backend by default.\n
+
+
+		<h3> How To Use </h3>
+
+		- Create the key function, for gen_instruct it can return the `op`
+		field. Let it be `key`.
+
+		- Create `sharded_process<info, decltype(key)>` passing `key`, the
+		processing function and the number of shards. The processing
+		function must be safe to be called from multiple threads for
+		different keys.
+
+		- Use as queued_process, `getShardDepth` gives the number of messages
+		pending in a shard and `shard` gives the queued_process of a shard
+		for its statistics and settings.
+
+		<h3>Example</h3>
+
+		\include{lineno} sharded_process_ex.cpp
+
+	*/
+	template<class instruct, class key_fn, class backend = locked_backend>
+	class sharded_process
+	{
+	public:
+
+		/**
+			\brief The type of object to be processed
+		*/
+		using info_type = instruct;
+
+		/**
+			\brief The type of each shard.
+		*/
+		using process_type = queued_process<info_type, backend>;
+
+		/**
+			\brief The function type that processes the infomation passed.
+		*/
+		using processing_method = typename process_type::processing_method;
+
+		/**
+			\brief The type of key extracted from messages.
+		*/
+		using key_type = std::decay_t<std::invoke_result_t<const key_fn&,
+			const info_type&>>;
+
+	private:
+
+		/**
+			\brief The function which extracts the key.
+		*/
+		key_fn key;
+
+		/**
+			\brief The number of shards.
+		*/
+		unsigned shard_count;
+
+		/**
+			\brief The shards.
+		*/
+		std::unique_ptr<process_type[]> shards;
+
+	public:
+
+		/**
+			\brief Constructs with the key function.
+		*/
+		explicit sharded_process(
+			key_fn k /**< : <i>in</i> : The key function.*/,
+			unsigned count = std::thread::hardware_concurrency() /**< :
+						<i>in</i> : The number of shards.*/
+		) : key(std::move(k)), shard_count(count ? count : 1),
+			shards(new process_type[shard_count])
+		{}
+
+		/**
+			\brief Constructs with the key function and registers the
+			processing method.
+		*/
+		sharded_process(
+			key_fn k /**< : <i>in</i> : The key function.*/,
+			processing_method msg /**< : <i>in</i> : The procedure.*/,
+			unsigned count = std::thread::hardware_concurrency() /**< :
+						<i>in</i> : The number of shards.*/
+		) : sharded_process(std::move(k), count)
+		{
+			RegisterProc(msg);
+		}
+
+		sharded_process(const sharded_process&) = delete;
+
+		sharded_process(sharded_process&&) = delete;
+
+		sharded_process& operator = (sharded_process&&) = delete;
+
+		sharded_process& operator = (const sharded_process&) = delete;
+
+		/**
+			\brief The Function to set a function as the instruction processor
+			of all shards.
+		*/
+		inline void RegisterProc(
+			processing_method in /**< : <i>in</i> : The procedure.*/
+		) noexcept
+		{
+			for (unsigned i = 0; i < shard_count; ++i)
+				shards[i].RegisterProc(in);
+		}
+
+		/**
+			\brief The number of shards.
+		*/
+		inline unsigned shardCount() const noexcept { return shard_count; }
+
+		/**
+			\brief The shard a key is processed by.
+		*/
+		inline unsigned shardOf(
+			const key_type& k /**< : <i>in</i> : The key.*/
+		) const noexcept
+		{
+			// mixes the hash so identity hashes of integers spread evenly.
+			unsigned long long h = static_cast<unsigned long long>(
+				std::hash<key_type>{}(k)) * 0x9E3779B97F4A7C15ULL;
+			return static_cast<unsigned>((h >> 32) % shard_count);
+		}
+
+		/**
+			\brief The queued_process of a shard.
+		*/
+		inline process_type& shard(
+			unsigned index /**< : <i>in</i> : The shard, less than 
+						   shardCount().*/
+		) noexcept
+		{
+			return shards[index];
+		}
+
+		/**
+			\brief The number of messages queued or being processed in a shard.
+		*/
+		inline unsigned long long getShardDepth(
+			unsigned index /**< : <i>in</i> : The shard, less than 
+						   shardCount().*/
+		) const noexcept
+		{
+			return shards[index].getPendingCount();
+		}
+
+		/**
+			\brief Bounds the number of queued messages of each shard, must be
+			called while not running.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if any shard refused.\n
+		*/
+		tristate setCapacity(
+			std::size_t max /**< : <i>in</i> : The maximum number of messages
+							per shard, 0 for unbounded.*/,
+			overflow_policy when_full = overflow_policy::BLOCK /**< : <i>in</i>
+							: What to do when full.*/
+		) noexcept
+		{
+			tristate ret = tristate::GOOD;
+			for (unsigned i = 0; i < shard_count; ++i)
+				if (!shards[i].setCapacity(max, when_full))
+					ret = tristate::ERROR;
+			return ret;
+		}
+
+		/**
+			\brief Sets how the workers wait for messages, must be called 
+			while not running.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if any shard is running.\n
+		*/
+		tristate setWaitStrategy(
+			wait_strategy how /**< : <i>in</i> : The wait strategy.*/,
+			unsigned spins = 4096 /**< : <i>in</i> : The number of spins
+								  before sleeping for SPIN_THEN_PARK.*/
+		) noexcept
+		{
+			tristate ret = tristate::GOOD;
+			for (unsigned i = 0; i < shard_count; ++i)
+				if (!shards[i].setWaitStrategy(how, spins))
+					ret = tristate::ERROR;
+			return ret;
+		}
+
+		/**
+			\brief starts the workers of all shards.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if no procedure was set or already 
+			running, no worker is left running then.\n
+		*/
+		tristate start_queue_process() noexcept
+		{
+			O3_LIB_LOG_LINE;
+			if (isQueueRunning())
+				return tristate::ERROR;
+			for (unsigned i = 0; i < shard_count; ++i)
+			{
+				if (!shards[i].start_queue_process())
+				{
+					force_join();
+					return tristate::ERROR;
+				}
+			}
+			O2_LIB_LOG_LINE;
+			return tristate::GOOD;
+		}
+
+		/**
+			\brief The function post a message onto the shard of its key.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if shard is bounded, full and message was
+			refused.\n
+		*/
+		inline tristate postMessage(
+			info_type Message /**< : <i>in</i> : Message need to be pushed.*/
+		)
+		{
+			unsigned index = shardOf(key(static_cast<const info_type&>(Message)));
+			return shards[index].postMessage(std::move(Message));
+		}
+
+		/**
+			\brief The function post a message onto the shard of its key and
+			returns the object to wait for the value returned by the handler.
+		*/
+		inline post_result postForResult(
+			info_type Message /**< : <i>in</i> : Message need to be pushed.*/
+		)
+		{
+			unsigned index = shardOf(key(static_cast<const info_type&>(Message)));
+			return shards[index].postForResult(std::move(Message));
+		}
+
+		/**
+			\brief The function to signal all workers to stop processing.
+		*/
+		inline void stopQueue() noexcept
+		{
+			for (unsigned i = 0; i < shard_count; ++i)
+				shards[i].stopQueue();
+		}
+
+		/**
+			\brief Checks if any worker is running.
+		*/
+		inline bool isQueueRunning() noexcept
+		{
+			for (unsigned i = 0; i < shard_count; ++i)
+				if (shards[i].isQueueRunning())
+					return true;
+			return false;
+		}
+
+		/**
+			\brief Waits till all workers stop. Then empties the shards.
+		*/
+		inline void WaitForQueueStop() noexcept
+		{
+			for (unsigned i = 0; i < shard_count; ++i)
+				shards[i].WaitForQueueStop();
+		}
+
+		/**
+			\brief Waits till all messages posted before are processed.
+
+			<h3>Return</h3>
+			Returns tristate::ERROR if any worker is not running or stops.\n
+		*/
+		inline tristate flush()
+		{
+			tristate ret = tristate::GOOD;
+			for (unsigned i = 0; i < shard_count; ++i)
+				if (!shards[i].flush())
+					ret = tristate::ERROR;
+			return ret;
+		}
+
+		/**
+			\brief The function to wait till all shards are empty.
+		*/
+		inline void WaitForQueueEmpty()
+		{
+			for (unsigned i = 0; i < shard_count; ++i)
+				shards[i].WaitForQueueEmpty();
+		}
+
+		/**
+			\brief Waits till all shards are empty then stops workers and joins.
+		*/
+		inline void safe_join()
+		{
+			if (!isQueueRunning())
+				return;
+			WaitForQueueEmpty();
+			stopQueue();
+			WaitForQueueStop();
+		}
+
+		/**
+			\brief Signals stop then waits for workers to join.
+
+			<b>Note</b> : Even if shards have messages left over, it will exit
+			and messages will be destroyed.
+		*/
+		inline void force_join()
+		{
+			stopQueue();
+			WaitForQueueStop();
+		}
+
+		/**
+			\brief The destructor. Exits without waiting for queue stop.
+		*/
+		~sharded_process()
+		{
+			force_join();
+		}
+	};
+
+}
+
+#endif
@@ -29,13 +29,19 @@
 #define TIMER_ENH_H						timer.enh.h
 
 #include "logger.enh.h"
+#include "histogram.enh.h"
+#include "queue_backend.enh.h"
 
+#include <algorithm>
 #include <chrono>
 #include <type_traits>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace enh
 {
@@ -108,6 +114,28 @@ namespace enh
 	constexpr bool isGoodTimerType_v<std::chrono::microseconds> = true;
 
 
+	/**
+		\brief The enumeration of what a timer does when it falls behind by a
+		period or more, because of a late wake-up or a long callback.
+	*/
+	enum class overrun_policy
+	{
+		CATCH_UP,	/**< \brief Every cycle missed is signalled back to
+					back till the timer is on time.*/
+		SKIP		/**< \brief The cycles missed are counted and skipped,
+					signalled once.*/
+	};
+
+	/**
+		\brief The structure of the cycles elapsed of a timer with the time
+		they were counted, read together by enh::timer::snapshot.
+	*/
+	struct timer_snapshot
+	{
+		unsigned long long cycle; /**< \brief The cycles elapsed.*/
+		time_pt time; /**< \brief The time the cycle was counted.*/
+	};
+
 	/**
 		\brief The class to create a timer that notifies all clients periodically.
 
@@ -125,19 +153,36 @@ namespace enh
 		But the template can be instanciated with nanoseconds and microseconds,
 		but object cannot be created.
 
+		With <code>precise</code> set, the timer can be created with
+		microseconds or milliseconds less than 5. It sleeps till a spin budget
+		before each deadline and spins the rest, which hits deadlines within
+		a few microseconds at the cost of that much cpu each cycle. The
+		budget is set by `setSpinBudget`.
+
+
+		Functions registered with `addCallback` are called on the timer
+		thread every cycle or every k cycles. Cycles are anchored to the
+		start of timer, a late cycle does not delay the ones after it. What
+		is done with cycles missed is selected by `setOverrunPolicy`.
+
+		Threads in `wait` are kept in a heap by the cycle they wait for, a
+		cycle wakes only the threads whose cycle is reached.
+
 
 		hasErrorHandlers        = false;\n
 		
 		<h3>template</h3>
 		-#  <code>unsigned _per</code> : The period of time between each notification.\n
 		-#  <code>unit</code> : The unit of time of period.\n
+		-#  <code>bool precise</code> : true to spin before each deadline.\n
 
 		<h3>Example</h3>
 
 		\include{lineno} timer_ex.cpp
 
 	*/
-	template<unsigned _per = 50U, class time_unit = std::chrono::milliseconds>
+	template<unsigned _per = 50U, class time_unit = std::chrono::milliseconds,
+		bool precise = false>
 	class timer
 	{
 	
@@ -153,13 +198,29 @@ namespace enh
 		*/
 		using unit = time_unit;
 
+		/**
+			\brief The type of function called each cycle, takes the cycles
+			elapsed.
+		*/
+		using callback = std::function<void(unsigned long long)>;
+
 	private:
 
+		/**
+			\brief The callback registered.
+		*/
+		struct timer_callback
+		{
+			unsigned long long id; /**< \brief The id returned on add.*/
+			unsigned every; /**< \brief The cycles between calls.*/
+			callback fn; /**< \brief The function.*/
+		};
+
 
 		//fails if not time unit.
 		static_assert(isGoodTimerType_v<unit>, "unit type must be time type");
 		//fails if period < 5ms
-		static_assert(!(std::is_same_v<std::chrono::milliseconds, unit> && (period < 5)),
+		static_assert(precise || !(std::is_same_v<std::chrono::milliseconds, unit> && (period < 5)),
 			"Precision cannot be achieved lower than 5ms");
 
 
@@ -184,16 +245,38 @@ namespace enh
 
 
 		/**
-			\brief The mutex to hold ownership over @ref elapsed_cycles and
-			the notifier.
+			\brief A thread sleeping in wait, lives on its stack.
+		*/
+		struct timer_waiter
+		{
+			unsigned long long target; /**< \brief The cycle waited for.*/
+			std::condition_variable cvWaiter; /**< \brief The object to
+											  notify this thread.*/
+			bool isReady; /**< \brief true once target is reached.*/
+		};
+
+		/**
+			\brief The order of waiters in heap, earliest target on top.
+		*/
+		struct later_target
+		{
+			inline bool operator ()(const timer_waiter* a,
+				const timer_waiter* b) const noexcept
+			{
+				return a->target > b->target;
+			}
+		};
+
+		/**
+			\brief The mutex guarding waiting.
 		*/
 		std::mutex mtxTimer;
 
 		/**
-			\brief The condition_variable to notify all client threads about 
-			the end of that period.
+			\brief The heap of waiters by target cycle, so each tick wakes only
+			the waiters whose target is reached.
 		*/
-		std::condition_variable cvTimer;
+		std::vector<timer_waiter*> waiting;
 
 		/**
 			\brief The variable to signal the end of the timer loop, set by 
@@ -208,7 +291,45 @@ namespace enh
 
 			The product of this and period gives time elapsed.
 		*/
-		unsigned long long elapsed_cycles;
+		std::atomic<unsigned long long> elapsed_cycles;
+
+		/**
+			\brief The number of threads sleeping in wait.
+		*/
+		std::atomic<unsigned> waiters;
+
+		/**
+			\brief The sequence of the snapshot, odd while it is written.
+		*/
+		std::atomic<unsigned> sequence;
+
+		/**
+			\brief The cycle of the snapshot.
+		*/
+		std::atomic<unsigned long long> snap_cycle;
+
+		/**
+			\brief The time of the snapshot, in ticks of high_res.
+		*/
+		std::atomic<time_pt::rep> snap_time;
+
+		/**
+			\brief Publishes the cycles elapsed, written only by the timer
+			thread.
+		*/
+		inline void publish(
+			unsigned long long cycle /**< : <i>in</i> : The cycles elapsed.*/,
+			time_pt at /**< : <i>in</i> : The time counted.*/
+		) noexcept
+		{
+			unsigned seq = sequence.load(std::memory_order_relaxed);
+			sequence.store(seq + 1, std::memory_order_relaxed);
+			// a reader seeing either value also sees the odd sequence.
+			snap_cycle.store(cycle, std::memory_order_release);
+			snap_time.store(at.time_since_epoch().count(), std::memory_order_release);
+			sequence.store(seq + 2, std::memory_order_release);
+			elapsed_cycles.store(cycle);
+		}
 
 
 		/**
@@ -221,6 +342,66 @@ namespace enh
 		*/
 		bool isTimerActive;
 
+		/**
+			\brief The callbacks registered, replaced as a whole on change
+			so the timer thread reads it without locking.
+		*/
+		std::shared_ptr<const std::vector<timer_callback>> callbacks;
+
+		/**
+			\brief The mutex to serialise changes to callbacks.
+		*/
+		std::mutex mtxCallback;
+
+		/**
+			\brief The id of next callback added.
+		*/
+		unsigned long long next_callback_id;
+
+		/**
+			\brief What is done with cycles missed.
+		*/
+		std::atomic<overrun_policy> policy;
+
+		/**
+			\brief The number of cycles started a period or more late.
+		*/
+		std::atomic<unsigned long long> overrun_count;
+
+		/**
+			\brief The number of cycles skipped.
+		*/
+		std::atomic<unsigned long long> skipped_cycles;
+
+		/**
+			\brief The time each cycle started after its deadline.
+		*/
+		latency_histogram<> lateness;
+
+		/**
+			\brief The time before each deadline spent spinning, in
+			nanoseconds, used only if precise.
+		*/
+		std::atomic<long long> spin_budget;
+
+		/**
+			\brief Calls callbacks due in cycles after last till current.
+		*/
+		inline void run_callbacks(
+			unsigned long long last /**< : <i>in</i> : The cycles elapsed
+									before.*/,
+			unsigned long long current /**< : <i>in</i> : The cycles elapsed
+									   now.*/
+		) noexcept
+		{
+			auto list = std::atomic_load(&callbacks);
+			if (!list)
+				return;
+			for (auto& i : *list)
+				if (current / i.every > last / i.every)
+					i.fn(current);
+		}
+
 
 
 		/**
@@ -231,13 +412,50 @@ namespace enh
 		*/
 		inline void single_period() noexcept
 		{
-			std::this_thread::sleep_until(timer_next);
+			if constexpr (precise)
+			{
+				time_pt wake = timer_next - std::chrono::nanoseconds(spin_budget.load());
+				if (high_res::now() < wake)
+					std::this_thread::sleep_until(wake);
+				for (unsigned spin = 0; high_res::now() < timer_next; ++spin)
+					cpu_relax(spin);
+			}
+			else
+				std::this_thread::sleep_until(timer_next);
+			time_pt now = high_res::now();
+			lateness.record(now - timer_next);
+			unsigned long long last = elapsed_cycles.load(std::memory_order_relaxed);
+			unsigned long long current = last + 1;
+			timer_next += unit(period);
+			if (now >= timer_next)
+			{
+				++overrun_count;
+				if (policy.load() == overrun_policy::SKIP)
+				{
+					unsigned long long behind = static_cast<unsigned long long>(
+						(now - timer_next) / unit(period)) + 1;
+					current += behind;
+					timer_next += unit(period) * behind;
+					skipped_cycles += behind;
+				}
+			}
+			publish(current, now);
+			// waiters increment before checking, so a waiter not counted
+			// here sees the new cycle.
+			if (waiters.load())
 			{
 				std::lock_guard<std::mutex> lock(mtxTimer);
-				++elapsed_cycles;
-				timer_next += unit(period);
+				while (!waiting.empty() && waiting.front()->target <= current)
+				{
+					timer_waiter* due = waiting.front();
+					std::pop_heap(waiting.begin(), waiting.end(), later_target());
+					waiting.pop_back();
+					due->isReady = true;
+					// notified under lock, the waiter owns cvWaiter.
+					due->cvWaiter.notify_one();
+				}
 			}
-			cvTimer.notify_all();
+			run_callbacks(last, current);
 		}
 
 
@@ -247,9 +465,8 @@ namespace enh
 		*/
 		void loop() noexcept
 		{
-			clear_stop();
-			elapsed_cycles = 0;
 			timer_start = high_res::now();
+			publish(0, timer_start);
 			timer_next = timer_start + unit(period);
 			while (!stopTimer.load())
 			{
@@ -265,13 +482,27 @@ namespace enh
 
 			The timer constructor also invokes enh::timer::start_timer.
 
-			Constructor fails assert if it is not a time type > ms.
+			Constructor fails assert if it is not a time type > ms, or
+			microseconds if precise.
 		*/
 		inline timer() noexcept
 		{
-			static_assert(isGoodTimer_v<unit>, "unit type must be std::chrono::milliseconds, seconds or hours");
+			static_assert(isGoodTimer_v<unit> ||
+				(precise && std::is_same_v<unit, std::chrono::microseconds>),
+				"unit type must be std::chrono::milliseconds, seconds or hours, or microseconds if precise");
 			isTimerActive = false;
+			spin_budget = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::min<std::chrono::nanoseconds>(unit(period) / 2,
+				std::chrono::microseconds(100))).count();
+			next_callback_id = 1;
+			policy = overrun_policy::CATCH_UP;
+			overrun_count = 0;
+			skipped_cycles = 0;
 			clear_stop();
+			waiters = 0;
+			sequence = 0;
+			snap_cycle = 0;
+			snap_time = 0;
 			elapsed_cycles = 0;
 			start_timer();
 		}
@@ -304,12 +535,24 @@ namespace enh
 		{
 			if (!isTimerActive)
 				start_timer();
-			std::unique_lock<std::mutex> lock(mtxTimer);
-			cvTimer.wait(lock,
-				[expected, this]() {
-					return elapsed_cycles >= expected;
-				});
-			return (elapsed_cycles - expected);
+			unsigned long long current = elapsed_cycles.load();
+			if (current >= expected)
+				return current - expected;
+			++waiters;
+			{
+				std::unique_lock<std::mutex> lock(mtxTimer);
+				current = elapsed_cycles.load();
+				if (current < expected)
+				{
+					timer_waiter self{ expected, {}, false };
+					waiting.push_back(&self);
+					std::push_heap(waiting.begin(), waiting.end(), later_target());
+					self.cvWaiter.wait(lock, [&self]() { return self.isReady; });
+					current = elapsed_cycles.load();
+				}
+			}
+			--waiters;
+			return current - expected;
 		}
 
 		/**
@@ -323,7 +566,7 @@ namespace enh
 		*/
 		inline unsigned long long wait() noexcept
 		{
-			return wait(elapsed_cycles + 1);
+			return wait(elapsed() + 1);
 		}
 
 		/**
@@ -346,14 +589,15 @@ namespace enh
 											to exit immediately.*/
 		) noexcept
 		{
-			unsigned long long expected = elapsed_cycles + mult_count;
-			while (elapsed_cycles < expected)
+			unsigned long long expected = elapsed() + mult_count;
+			unsigned long long current;
+			while ((current = elapsed()) < expected)
 			{
 				if (!condition())
 					return -1;
 				wait();
 			}
-			return elapsed_cycles - expected;
+			return current - expected;
 		}
 		
 		/**
@@ -383,9 +627,35 @@ namespace enh
 		}
 
 		/**
-			\brief Returns the number of cycles elapsed from timer start.
+			\brief Returns the number of cycles elapsed from timer start, a
+			single atomic load.
 		*/
-		inline unsigned long long elapsed() noexcept { return elapsed_cycles; }
+		inline unsigned long long elapsed() const noexcept
+		{
+			return elapsed_cycles.load(std::memory_order_acquire);
+		}
+
+		/**
+			\brief Returns the cycles elapsed with the time they were counted,
+			read consistently without locking.
+		*/
+		inline timer_snapshot snapshot() const noexcept
+		{
+			for (unsigned i = 0; ; ++i)
+			{
+				unsigned begin = sequence.load(std::memory_order_acquire);
+				if (!(begin & 1))
+				{
+					timer_snapshot ret{ snap_cycle.load(std::memory_order_acquire),
+						time_pt(time_pt::duration(
+							snap_time.load(std::memory_order_acquire))) };
+					if (sequence.load(std::memory_order_relaxed) == begin)
+						return ret;
+				}
+				if (i % 64 == 63)
+					std::this_thread::yield();
+			}
+		}
 
 		/**
 			\brief blocks function execution for mult_count number of cycles.
@@ -396,7 +666,120 @@ namespace enh
 			unsigned long mult_count /**< : <i>in</i> : The cycles to wait for.*/
 		)noexcept
 		{
-			return wait(elapsed_cycles + mult_count);
+			return wait(elapsed() + mult_count);
+		}
+
+		/**
+			\brief Registers a function to be called on the timer thread every
+			number of cycles passed, with the cycles elapsed.
+
+			The function must return quickly, a function taking longer than
+			a period makes the timer overrun.
+
+			<h3>Return</h3>
+			The id to remove the callback.\n
+		*/
+		unsigned long long addCallback(
+			callback fn /**< : <i>in</i> : The function.*/,
+			unsigned every = 1 /**< : <i>in</i> : The cycles between calls, 0
+							   is taken as 1.*/
+		)
+		{
+			std::lock_guard<std::mutex> lock(mtxCallback);
+			auto list = std::make_shared<std::vector<timer_callback>>();
+			if (callbacks)
+				*list = *callbacks;
+			unsigned long long id = next_callback_id++;
+			list->push_back(timer_callback{ id, every ? every : 1, std::move(fn) });
+			std::atomic_store(&callbacks,
+				std::shared_ptr<const std::vector<timer_callback>>(std::move(list)));
+			return id;
+		}
+
+		/**
+			\brief Removes a callback, it may be called once more if the timer
+			thread is calling callbacks.
+
+			<h3>Return</h3>
+			Returns false if id is not of a callback registered.\n
+		*/
+		bool removeCallback(
+			unsigned long long id /**< : <i>in</i> : The id returned by
+								  addCallback.*/
+		)
+		{
+			std::lock_guard<std::mutex> lock(mtxCallback);
+			if (!callbacks)
+				return false;
+			auto list = std::make_shared<std::vector<timer_callback>>();
+			for (auto& i : *callbacks)
+				if (i.id != id)
+					list->push_back(i);
+			if (list->size() == callbacks->size())
+				return false;
+			std::atomic_store(&callbacks,
+				std::shared_ptr<const std::vector<timer_callback>>(std::move(list)));
+			return true;
+		}
+
+		/**
+			\brief Sets what is done with cycles missed, default is
+			overrun_policy::CATCH_UP.
+		*/
+		inline void setOverrunPolicy(
+			overrun_policy how /**< : <i>in</i> : The policy.*/
+		) noexcept
+		{
+			policy = how;
+		}
+
+		/**
+			\brief Sets the time before each deadline the timer thread spins
+			instead of sleeping, used only if precise, default is the smaller
+			of half the period and 100 microseconds.
+
+			A larger budget absorbs more of the lateness of the sleep, a
+			budget of period keeps the timer thread always spinning, which
+			starves other threads if cores are few.
+		*/
+		template<class Rep, class Period>
+		inline void setSpinBudget(
+			std::chrono::duration<Rep, Period> budget /**< : <i>in</i> : The
+											time to spin.*/
+		) noexcept
+		{
+			spin_budget = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				budget).count();
+		}
+
+		/**
+			\brief The number of cycles started a period or more late since
+			timer start.
+		*/
+		inline unsigned long long getOverrunCount() const noexcept
+		{
+			return overrun_count.load();
+		}
+
+		/**
+			\brief The number of cycles skipped by overrun_policy::SKIP since
+			timer start.
+		*/
+		inline unsigned long long getSkippedCycles() const noexcept
+		{
+			return skipped_cycles.load();
+		}
+
+		/**
+			\brief The distribution of time each cycle started after its
+			deadline, in nanoseconds, since timer start.
+
+			Cycles that missed their deadline by a period or more are counted
+			by getOverrunCount.
+		*/
+		inline const latency_histogram<>& getJitter() const noexcept
+		{
+			return lateness;
 		}
 
 		/**
@@ -440,8 +823,11 @@ namespace enh
 				return false;
 			O3_LIB_LOG_LINE;
 			clear_stop();
-			elapsed_cycles = 0;
-			timerThread = std::thread(&timer<period, unit>::loop, this);
+			publish(0, high_res::now());
+			overrun_count = 0;
+			skipped_cycles = 0;
+			lateness.reset();
+			timerThread = std::thread(&timer::loop, this);
 			isTimerActive = true;
 			return true;
 		}
@@ -483,8 +869,8 @@ namespace enh
 		}
 	};
 
-	template<unsigned a, class b>
-	time_pt timer<a,b>::program_start = high_res::now();
+	template<unsigned a, class b, bool c>
+	time_pt timer<a, b, c>::program_start = high_res::now();
 
 	/**
 		\brief The enh::timer class with unit <code>std::chrono::
@@ -510,7 +896,7 @@ namespace enh
 		microseconds from program start.
 
 		<b>NOTE : </b> An object of this type cannot be created, it would
-		fail an assert in the constructor.
+		fail an assert in the constructor, use @ref enh::precise_micros.
 	*/
 	using micros = timer<50, std::chrono::microseconds>;
 
@@ -548,6 +934,22 @@ namespace enh
 	template<unsigned period = 50U>
 	using seconds = timer<period, std::chrono::seconds>;
 
+	/**
+		\brief The precise enh::timer class with unit <code>std::chrono::
+		microseconds</code>
+
+
+		The alias of a timer class template instanciated with
+		<code>std::chrono::microseconds</code> that spins before each
+		deadline.
+
+		<h3>Template</h3>
+		<code>unsigned period</code> : The period of one cycle in the timer,
+		default value 200.
+	*/
+	template<unsigned period = 200U>
+	using precise_micros = timer<period, std::chrono::microseconds, true>;
+
 	/**
 		\brief The enh::timer class with unit <code>std::chrono::
 		minutes</code>
@@ -0,0 +1,635 @@
+/** ***************************************************************************
+	\file timer_wheel.enh.h
+
+	\brief The file to declare class timer_wheel
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+******************************************************************************/
+
+#ifndef TIMER_WHEEL_ENH_H
+
+#define TIMER_WHEEL_ENH_H						timer_wheel.enh.h
+
+#include "timer.enh.h"
+
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace enh
+{
+
+	/**
+		\brief The class to run any number of one-shot and periodic timers
+		on one thread.
+
+
+		The wheel ticks once every period, like @ref enh::timer, and keeps
+		timers in 4 levels of 256 slots each. A timer is placed in the level
+		whose range covers its deadline and moved to a lower level when the
+		wheel reaches its slot, so scheduling, cancelling and expiring a
+		timer take constant time irrespective of the number of timers.
+		Deadlines beyond 2^32 ticks are moved down as many times as needed.
+
+		Ticks are anchored to the start of the wheel, a late wake-up
+		processes all ticks missed so timers do not drift.
+
+		Callbacks are called on the wheel thread without any lock held, so
+		they can schedule or cancel timers. Long callbacks delay the timers
+		after them, post such work to a queued_process instead.
+
+
+		hasErrorHandlers        = false;\n
+
+		<h3>template</h3>
+		-#  <code>unsigned _per</code> : The period of one tick, the
+		resolution of timers.\n
+		-#  <code>time_unit</code> : The unit of time of period.\n
+
+		<h3> How To Use </h3>
+
+		- Call `start` to start the wheel thread.
+
+		- Call `schedule_after` for a one-shot timer and `schedule_every` for
+		a periodic timer, both return an id.
+
+		- Call `cancel` with the id to remove a timer.
+
+		- Call `force_join` or destroy the wheel to stop it, timers left are
+		not called.
+
+		<h3>Example</h3>
+
+		\include{lineno} timer_wheel_ex.cpp
+
+	*/
+	template<unsigned _per = 10U, class time_unit = std::chrono::milliseconds>
+	class timer_wheel
+	{
+	public:
+
+		/**
+			\brief The period of one tick.
+		*/
+		static constexpr unsigned period = _per;
+
+		/**
+			\brief The unit of measurement.
+		*/
+		using unit = time_unit;
+
+		/**
+			\brief The type of function called on expiry.
+		*/
+		using callback = std::function<void()>;
+
+		/**
+			\brief The type of id of a timer, never 0.
+		*/
+		using timer_id = unsigned long long;
+
+	private:
+
+		static_assert(isGoodTimer_v<unit>, "unit type must be std::chrono::milliseconds, seconds, minutes or hours");
+		static_assert(period > 0, "period must not be 0");
+
+		/**
+			\brief The number of bits of tick used by each level.
+		*/
+		static constexpr unsigned level_bits = 8;
+
+		/**
+			\brief The number of slots in each level.
+		*/
+		static constexpr unsigned slot_count = 1U << level_bits;
+
+		/**
+			\brief The number of levels.
+		*/
+		static constexpr unsigned level_count = 4;
+
+		/**
+			\brief The index marking end of a list.
+		*/
+		static constexpr std::uint32_t none = ~std::uint32_t(0);
+
+		/**
+			\brief The states of a timer.
+		*/
+		enum class timer_state : unsigned char
+		{
+			FREE,		/**< \brief The node is not used.*/
+			PENDING,	/**< \brief The timer is in a slot.*/
+			FIRING,		/**< \brief The callback is being called.*/
+			CANCELLED	/**< \brief The timer was cancelled while firing.*/
+		};
+
+		/**
+			\brief The node of a timer, linked in a slot by index.
+		*/
+		struct timer_node
+		{
+			callback fn; /**< \brief The function called on expiry.*/
+			unsigned long long expiry; /**< \brief The tick of expiry.*/
+			unsigned long long repeat; /**< \brief The ticks between
+									   expiries, 0 if one-shot.*/
+			std::uint32_t prev; /**< \brief The previous node in slot.*/
+			std::uint32_t next; /**< \brief The next node in slot or free
+								list.*/
+			std::uint32_t slot; /**< \brief The slot the node is in.*/
+			std::uint32_t generation; /**< \brief Increased on every reuse
+									  to detect stale ids.*/
+			timer_state state; /**< \brief The state.*/
+		};
+
+		/**
+			\brief The nodes of all timers.
+		*/
+		std::vector<timer_node> nodes;
+
+		/**
+			\brief The first free node.
+		*/
+		std::uint32_t free_head;
+
+		/**
+			\brief The first node of each slot, slot s of level l at
+			l * slot_count + s.
+		*/
+		std::array<std::uint32_t, slot_count * level_count> slots;
+
+		/**
+			\brief The number of timers scheduled.
+		*/
+		std::size_t count;
+
+		/**
+			\brief The ticks processed since start.
+		*/
+		std::atomic<unsigned long long> ticks;
+
+		/**
+			\brief The time wheel was started.
+		*/
+		time_pt timer_start;
+
+		/**
+			\brief The mutex guarding timers.
+		*/
+		std::mutex mtxWheel;
+
+		/**
+			\brief The condition_variable wheel thread sleeps on between ticks.
+		*/
+		std::condition_variable cvWheel;
+
+		/**
+			\brief The variable to signal the end of the wheel thread.
+		*/
+		std::atomic<bool> stopWheel;
+
+		/**
+			\brief The thread handle to the wheel thread.
+		*/
+		std::thread wheelThread;
+
+		/**
+			\brief Adds a node to a slot.
+		*/
+		inline void link(
+			std::uint32_t index /**< : <i>in</i> : The node.*/,
+			std::uint32_t slot /**< : <i>in</i> : The slot.*/
+		) noexcept
+		{
+			timer_node& node = nodes[index];
+			node.slot = slot;
+			node.prev = none;
+			node.next = slots[slot];
+			if (node.next != none)
+				nodes[node.next].prev = index;
+			slots[slot] = index;
+		}
+
+		/**
+			\brief Removes a node from its slot.
+		*/
+		inline void unlink(
+			std::uint32_t index /**< : <i>in</i> : The node.*/
+		) noexcept
+		{
+			timer_node& node = nodes[index];
+			if (node.prev != none)
+				nodes[node.prev].next = node.next;
+			else
+				slots[node.slot] = node.next;
+			if (node.next != none)
+				nodes[node.next].prev = node.prev;
+		}
+
+		/**
+			\brief Places a node in the slot for its expiry, expiry not after
+			current tick is placed in the slot of current tick.
+		*/
+		void place(
+			std::uint32_t index /**< : <i>in</i> : The node.*/
+		) noexcept
+		{
+			unsigned long long now = ticks.load(std::memory_order_relaxed);
+			unsigned long long expiry = nodes[index].expiry;
+			unsigned long long delta = (expiry > now) ? expiry - now : 0;
+			if (delta == 0)
+				expiry = now;
+			unsigned level = 0;
+			while (level < level_count - 1 &&
+				delta >= (1ULL << (level_bits * (level + 1))))
+				++level;
+			if (delta >= (1ULL << (level_bits * level_count)))
+				expiry = now + (1ULL << (level_bits * level_count)) - 1;
+			link(index, static_cast<std::uint32_t>(level * slot_count +
+				((expiry >> (level_bits * level)) & (slot_count - 1))));
+		}
+
+		/**
+			\brief Takes a free node, growing storage if none.
+		*/
+		std::uint32_t allocate()
+		{
+			if (free_head == none)
+			{
+				nodes.emplace_back();
+				nodes.back().generation = 0;
+				nodes.back().state = timer_state::FREE;
+				return static_cast<std::uint32_t>(nodes.size() - 1);
+			}
+			std::uint32_t index = free_head;
+			free_head = nodes[index].next;
+			return index;
+		}
+
+		/**
+			\brief Returns a node to free list.
+		*/
+		inline void release(
+			std::uint32_t index /**< : <i>in</i> : The node.*/
+		) noexcept
+		{
+			timer_node& node = nodes[index];
+			node.fn = nullptr;
+			node.state = timer_state::FREE;
+			++node.generation;
+			node.next = free_head;
+			free_head = index;
+			--count;
+		}
+
+		/**
+			\brief Adds a timer.
+		*/
+		timer_id add(
+			unsigned long long delay /**< : <i>in</i> : The ticks till
+									 first expiry.*/,
+			unsigned long long repeat /**< : <i>in</i> : The ticks between
+									  expiries.*/,
+			callback fn /**< : <i>in</i> : The function.*/
+		)
+		{
+			std::lock_guard<std::mutex> lock(mtxWheel);
+			std::uint32_t index = allocate();
+			timer_node& node = nodes[index];
+			node.fn = std::move(fn);
+			node.expiry = ticks.load(std::memory_order_relaxed) +
+				(delay ? delay : 1);
+			node.repeat = repeat;
+			node.state = timer_state::PENDING;
+			++count;
+			place(index);
+			return (static_cast<unsigned long long>(node.generation + 1) << 32)
+				| index;
+		}
+
+		/**
+			\brief The ticks covering a duration, rounded up.
+		*/
+		template<class Rep, class Period>
+		static inline unsigned long long to_ticks(
+			std::chrono::duration<Rep, Period> delay /**< : <i>in</i> : The
+											duration.*/
+		) noexcept
+		{
+			auto tick = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				unit(period)).count();
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				delay).count();
+			return (ns > 0) ? static_cast<unsigned long long>((ns + tick - 1) / tick) : 0;
+		}
+
+		/**
+			\brief Advances one tick, moves timers of higher levels whose slot
+			is reached down and calls timers expired.
+		*/
+		void advance(
+			std::unique_lock<std::mutex>& lock /**< : <i>in</i> : The lock
+											   held on mtxWheel.*/
+		)
+		{
+			unsigned long long now = ticks.load(std::memory_order_relaxed) + 1;
+			ticks.store(now, std::memory_order_relaxed);
+
+			unsigned top = 0;
+			while (top < level_count - 1 &&
+				((now >> (level_bits * (top + 1))) << (level_bits * (top + 1))) == now)
+				++top;
+			for (unsigned level = top; level > 0; --level)
+			{
+				std::uint32_t slot = static_cast<std::uint32_t>(level * slot_count +
+					((now >> (level_bits * level)) & (slot_count - 1)));
+				std::uint32_t index = slots[slot];
+				slots[slot] = none;
+				while (index != none)
+				{
+					std::uint32_t next = nodes[index].next;
+					place(index);
+					index = next;
+				}
+			}
+
+			std::uint32_t slot = static_cast<std::uint32_t>(now & (slot_count - 1));
+			if (slots[slot] == none)
+				return;
+			std::vector<std::pair<std::uint32_t, callback>> firing;
+			std::uint32_t index = slots[slot];
+			slots[slot] = none;
+			while (index != none)
+			{
+				timer_node& node = nodes[index];
+				std::uint32_t next = node.next;
+				if (node.expiry <= now)
+				{
+					node.state = timer_state::FIRING;
+					firing.emplace_back(index, std::move(node.fn));
+				}
+				else
+					place(index);
+				index = next;
+			}
+
+			for (auto& i : firing)
+			{
+				// a callback called before may have cancelled this one.
+				if (nodes[i.first].state != timer_state::FIRING)
+					continue;
+				lock.unlock();
+				i.second();
+				lock.lock();
+			}
+
+			for (auto& i : firing)
+			{
+				timer_node& node = nodes[i.first];
+				if (node.state == timer_state::FIRING && node.repeat)
+				{
+					node.fn = std::move(i.second);
+					node.expiry += node.repeat;
+					// a callback longer than the interval skips the expiries
+					// missed, current slot is already emptied.
+					if (node.expiry <= now)
+						node.expiry = now + 1;
+					node.state = timer_state::PENDING;
+					place(i.first);
+				}
+				else
+					release(i.first);
+			}
+		}
+
+		/**
+			\brief Sleeps till each tick and advances the wheel till
+			stopWheel is set.
+		*/
+		void loop() noexcept
+		{
+			O3_LIB_LOG_LINE;
+			std::unique_lock<std::mutex> lock(mtxWheel);
+			while (!stopWheel.load())
+			{
+				time_pt next = timer_start +
+					unit(period) * (ticks.load(std::memory_order_relaxed) + 1);
+				if (cvWheel.wait_until(lock, next, [this]() { return stopWheel.load(); }))
+					break;
+				time_pt now = high_res::now();
+				while (!stopWheel.load() && timer_start + unit(period) *
+					(ticks.load(std::memory_order_relaxed) + 1) <= now)
+					advance(lock);
+			}
+			O4_LIB_LOG_LINE;
+		}
+
+	public:
+
+		/**
+			\brief Constructs a wheel with no timers, not started.
+		*/
+		timer_wheel() noexcept : free_head(none), count(0), ticks(0),
+			stopWheel(false)
+		{
+			slots.fill(none);
+		}
+
+		timer_wheel(const timer_wheel&) = delete;
+
+		timer_wheel& operator = (const timer_wheel&) = delete;
+
+		/**
+			\brief Starts the wheel thread, timers scheduled before are
+			counted from now.
+
+			<h3>Return</h3>
+			Returns false if wheel is already running.\n
+		*/
+		bool start()
+		{
+			if (wheelThread.joinable())
+				return false;
+			O3_LIB_LOG_LINE;
+			stopWheel = false;
+			{
+				std::lock_guard<std::mutex> lock(mtxWheel);
+				timer_start = high_res::now() - unit(period) *
+					ticks.load(std::memory_order_relaxed);
+			}
+			wheelThread = std::thread(&timer_wheel::loop, this);
+			return true;
+		}
+
+		/**
+			\brief Schedules a function to be called once, after at least the
+			number of ticks passed.
+
+			<h3>Return</h3>
+			The id of timer.\n
+		*/
+		inline timer_id schedule_after(
+			unsigned long long delay /**< : <i>in</i> : The ticks to wait.*/,
+			callback fn /**< : <i>in</i> : The function.*/
+		)
+		{
+			return add(delay + 1, 0, std::move(fn));
+		}
+
+		/**
+			\brief Schedules a function to be called once, after at least the
+			duration passed.
+
+			<h3>Return</h3>
+			The id of timer.\n
+		*/
+		template<class Rep, class Period>
+		inline timer_id schedule_after(
+			std::chrono::duration<Rep, Period> delay /**< : <i>in</i> : The
+											duration to wait.*/,
+			callback fn /**< : <i>in</i> : The function.*/
+		)
+		{
+			return schedule_after(to_ticks(delay), std::move(fn));
+		}
+
+		/**
+			\brief Schedules a function to be called every number of ticks
+			passed, first after that many ticks.
+
+			<h3>Return</h3>
+			The id of timer.\n
+		*/
+		inline timer_id schedule_every(
+			unsigned long long interval /**< : <i>in</i> : The ticks between
+										calls, 0 is taken as 1.*/,
+			callback fn /**< : <i>in</i> : The function.*/
+		)
+		{
+			interval = interval ? interval : 1;
+			return add(interval, interval, std::move(fn));
+		}
+
+		/**
+			\brief Schedules a function to be called every duration passed,
+			rounded up to ticks.
+
+			<h3>Return</h3>
+			The id of timer.\n
+		*/
+		template<class Rep, class Period>
+		inline timer_id schedule_every(
+			std::chrono::duration<Rep, Period> interval /**< : <i>in</i> : The
+											duration between calls.*/,
+			callback fn /**< : <i>in</i> : The function.*/
+		)
+		{
+			return schedule_every(to_ticks(interval), std::move(fn));
+		}
+
+		/**
+			\brief Cancels a timer, a timer whose callback is running is not
+			called again, one due in the same tick whose callback has not
+			started is not called.
+
+			<h3>Return</h3>
+			Returns false if id is not of a timer scheduled.\n
+		*/
+		bool cancel(
+			timer_id id /**< : <i>in</i> : The id of timer.*/
+		) noexcept
+		{
+			std::uint32_t index = static_cast<std::uint32_t>(id);
+			std::uint32_t generation = static_cast<std::uint32_t>(id >> 32) - 1;
+			std::lock_guard<std::mutex> lock(mtxWheel);
+			if (index >= nodes.size() || nodes[index].generation != generation)
+				return false;
+			timer_node& node = nodes[index];
+			switch (node.state)
+			{
+			case timer_state::PENDING:
+				unlink(index);
+				release(index);
+				return true;
+			case timer_state::FIRING:
+				node.state = timer_state::CANCELLED;
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/**
+			\brief The number of timers scheduled.
+		*/
+		inline std::size_t pending() noexcept
+		{
+			std::lock_guard<std::mutex> lock(mtxWheel);
+			return count;
+		}
+
+		/**
+			\brief Returns the number of ticks elapsed.
+		*/
+		inline unsigned long long elapsed() const noexcept
+		{
+			return ticks.load(std::memory_order_relaxed);
+		}
+
+		/**
+			\brief Checks if wheel is running.
+		*/
+		inline bool isWheelRunning() const noexcept
+		{
+			return wheelThread.joinable();
+		}
+
+		/**
+			\brief Stops the wheel thread and waits till it joins, timers are
+			kept and continue when started again.
+		*/
+		void force_join() noexcept
+		{
+			if (!wheelThread.joinable())
+				return;
+			{
+				std::lock_guard<std::mutex> lock(mtxWheel);
+				stopWheel = true;
+			}
+			cvWheel.notify_all();
+			wheelThread.join();
+		}
+
+		/**
+			\brief The destructor, stops the wheel, timers left are not
+			called.
+		*/
+		~timer_wheel()
+		{
+			force_join();
+		}
+	};
+
+}
+
+#endif
@@ -28,58 +28,771 @@
 
 #if  defined(ENH_DEBUG_CONTROL) && (ENH_OPTIMISATION < 5)
 #include <map>
+#include <algorithm>
+#include <unordered_map>
+#include <deque>
 #include <fstream>
-#include <exception>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
 
 
-// setup will indicate if no file existed previously
-std::string Register(bool& setup, std::string function, std::thread::id id = std::this_thread::get_id())
+namespace
 {
-	static std::map<std::thread::id, std::string> call_info; // To store thread id based log-file
-	std::string ret;
-	setup = false;
-	try {
-		ret = call_info.at(id);
+	// a file logged into, never destroyed once created
+	struct log_target
+	{
+		std::filesystem::path file;
+		bool binary;
+	};
+
+	// log file name of every thread that logged, sharded by thread id, and
+	// the files logged into
+	class file_index
+	{
+		static constexpr std::size_t shard_count = 16;
+
+		struct alignas(64) shard
+		{
+			std::mutex mtxShard;
+			std::unordered_map<std::thread::id, std::string> names;
+		};
+
+		shard shards[shard_count];
+
+		std::mutex mtxTargets;
+		std::map<std::filesystem::path, std::unique_ptr<log_target>> targets;
+
+	public:
+
+		// name registered for id, function is registered if none was.
+		// setup will indicate if no file existed previously
+		std::string find(bool& setup, std::thread::id id, const std::string& function)
+		{
+			shard& current = shards[std::hash<std::thread::id>{}(id) % shard_count];
+			std::lock_guard<std::mutex> lock(current.mtxShard);
+			auto ret = current.names.emplace(id, function);
+			setup = ret.second;
+			return ret.first->second;
+		}
+
+		// the target for file, created on first use
+		const log_target& target(const std::filesystem::path& file, bool binary)
+		{
+			std::lock_guard<std::mutex> lock(mtxTargets);
+			auto& ret = targets[file];
+			if (!ret)
+				ret.reset(new log_target{ file, binary });
+			return *ret;
+		}
+	};
+
+	// never destroyed, threads may log during static destruction
+	file_index& index()
+	{
+		static file_index* instance = new file_index;
+		return *instance;
 	}
-	catch (std::out_of_range)
+
+	std::atomic<debug::log_format> format{ debug::log_format::TEXT };
+
+	// true if file, the name passed to setLogOptimisation, is path or its
+	// trailing part
+	bool fileMatches(std::string_view path, std::string_view file)
 	{
-		call_info.emplace(id, function);
-		ret = function;
-		setup = true;
+		if (file.size() > path.size() || path.substr(path.size() - file.size()) != file)
+			return false;
+		if (file.size() == path.size())
+			return true;
+		char separator = path[path.size() - file.size() - 1];
+		return separator == '/' || separator == '\\';
+	}
+
+	// call sites of logging macros, registered before main, and the
+	// optimisation levels set at runtime
+	class site_registry
+	{
+		struct entry
+		{
+			const debug::log_site* site;
+			std::atomic<bool>* enabled;
+		};
+
+		std::vector<entry> sites;
+		std::map<std::string, unsigned> files;
+		std::map<std::pair<std::string, unsigned long>, unsigned> lines;
+
+		// optimisation level for site, line overrides file overrides global,
+		// the longest matching file is used
+		unsigned optimisation(const debug::log_site& site) const
+		{
+			const std::pair<const std::pair<std::string, unsigned long>, unsigned>* line = nullptr;
+			for (auto& i : lines)
+				if (i.first.second == site.line && fileMatches(site.file, i.first.first)
+					&& (!line || i.first.first.size() > line->first.first.size()))
+					line = &i;
+			if (line)
+				return line->second;
+			const std::pair<const std::string, unsigned>* file = nullptr;
+			for (auto& i : files)
+				if (fileMatches(site.file, i.first) && (!file || i.first.size() > file->first.size()))
+					file = &i;
+			if (file)
+				return file->second;
+			return global.load(std::memory_order_relaxed);
+		}
+
+	public:
+
+		std::mutex mtxSites;
+		std::atomic<unsigned> global{ 0 };
+
+		site_registry()
+		{
+			if (const char* level = std::getenv("ENH_LOG_OPTIMISATION"))
+				global = static_cast<unsigned>(std::strtoul(level, nullptr, 10));
+		}
+
+		// lock mtxSites before the members below
+
+		void add(const debug::log_site& site, std::atomic<bool>& enabled)
+		{
+			sites.push_back({ &site, &enabled });
+			enabled.store(site.level > optimisation(site), std::memory_order_relaxed);
+		}
+
+		void setFile(std::string_view file, unsigned level)
+		{
+			files[std::string(file)] = level;
+		}
+
+		void setLine(std::string_view file, unsigned long line, unsigned level)
+		{
+			lines[{ std::string(file), line }] = level;
+		}
+
+		void clear()
+		{
+			files.clear();
+			lines.clear();
+		}
+
+		// recomputes enabled of all sites
+		void update()
+		{
+			for (auto& i : sites)
+				i.enabled->store(i.site->level > optimisation(*i.site), std::memory_order_relaxed);
+		}
+
+		std::vector<const debug::log_site*> list() const
+		{
+			std::vector<const debug::log_site*> ret;
+			ret.reserve(sites.size());
+			for (auto& i : sites)
+				ret.push_back(i.site);
+			return ret;
+		}
+	};
+
+	// never destroyed, sites register during static initialisation
+	site_registry& registry()
+	{
+		static site_registry* instance = new site_registry;
+		return *instance;
 	}
-	return ret;
 }
 
-//write to path
-void write(std::string buff, std::filesystem::path file)
+//write bytes to target, opening it for this record only
+void write_now(const std::string& bytes, const log_target& target)
 {
-	std::ofstream out(file, std::ios::app | std::ios::out);
-	out << buff << "\n";
+	std::ofstream out(target.file, target.binary
+		? std::ios::app | std::ios::out | std::ios::binary : std::ios::app | std::ios::out);
+	out << bytes;
 }
 
-std::filesystem::path debug::getFile(std::thread::id id, std::string function)
+#ifndef ENH_LOG_SYNC
+
+namespace
+{
+	// one record to be written to a file
+	struct log_record
+	{
+		const log_target* target = nullptr;
+		std::string bytes;
+	};
+
+	// records logged by one thread, pushed only by it and popped only by the
+	// flusher
+	struct thread_buffer
+	{
+		static constexpr std::size_t capacity = 4096;
+
+		std::unique_ptr<log_record[]> slots{ new log_record[capacity] };
+		alignas(64) std::atomic<std::size_t> head{ 0 };
+		alignas(64) std::atomic<std::size_t> tail{ 0 };
+		std::atomic<bool> orphaned{ false };
+
+		// targets written from this buffer, used only by the flusher
+		std::vector<const log_target*> targets;
+
+		bool push(log_record& record)
+		{
+			std::size_t pos = tail.load(std::memory_order_relaxed);
+			if (pos - head.load(std::memory_order_acquire) == capacity)
+				return false;
+			slots[pos % capacity] = std::move(record);
+			tail.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		std::size_t size() const
+		{
+			return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+		}
+	};
+
+	// true once the backend is destroyed, records are then written at once
+	std::atomic<bool> backend_closed{ false };
+
+	// the flusher thread and the buffers of all threads
+	class log_backend
+	{
+		std::mutex mtxThreads;
+		std::vector<std::shared_ptr<thread_buffer>> threads;
+
+		std::mutex mtxFlush;
+		std::condition_variable cvFlush;
+		std::condition_variable cvFlushed;
+		std::atomic<bool> stopFlush{ false };
+		std::atomic<unsigned long long> requested{ 0 };
+		unsigned long long completed = 0;
+		// set once the flusher made its last drain, under mtxFlush
+		bool flushStopped = false;
+
+		// threads with a full buffer sleep on cvSpace till a drain
+		std::mutex mtxSpace;
+		std::condition_variable cvSpace;
+		std::atomic<unsigned> waitingSpace{ 0 };
+
+		// files kept open while a buffer writing to them is attached, used
+		// only by the flusher
+		std::unordered_map<const log_target*, std::ofstream> files;
+
+		std::thread flusher;
+
+		void drain()
+		{
+			std::vector<std::shared_ptr<thread_buffer>> current;
+			{
+				std::lock_guard<std::mutex> lock(mtxThreads);
+				current = threads;
+			}
+			bool any_orphan = false;
+			for (auto& i : current)
+			{
+				// orphaned read before draining, a thread exits after its
+				// last push.
+				bool orphan = i->orphaned.load();
+				any_orphan = any_orphan || orphan;
+				const log_target* last = nullptr;
+				std::ofstream* out = nullptr;
+				std::size_t pos = i->head.load(std::memory_order_relaxed);
+				std::size_t end = i->tail.load(std::memory_order_acquire);
+				for (; pos != end; ++pos)
+				{
+					log_record& record = i->slots[pos % thread_buffer::capacity];
+					if (record.target != last)
+					{
+						last = record.target;
+						if (std::find(i->targets.begin(), i->targets.end(), last) == i->targets.end())
+							i->targets.push_back(last);
+						auto file = files.find(last);
+						if (file == files.end())
+							file = files.emplace(last, std::ofstream(last->file, last->binary
+								? std::ios::app | std::ios::out | std::ios::binary
+								: std::ios::app | std::ios::out)).first;
+						out = &file->second;
+					}
+					*out << record.bytes;
+					record.bytes.clear();
+					i->head.store(pos + 1, std::memory_order_release);
+				}
+			}
+			for (auto& i : files)
+				i.second.flush();
+			// pairs with the fence in waitSpace, either the thread sees the
+			// records drained or it is seen waiting here.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (waitingSpace.load() > 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mtxSpace);
+				}
+				cvSpace.notify_all();
+			}
+			if (any_orphan)
+			{
+				// order kept, a thread reusing the id of an exited one
+				// appends after it.
+				std::lock_guard<std::mutex> lock(mtxThreads);
+				bool erased = false;
+				for (auto i = threads.begin(); i != threads.end();)
+				{
+					if ((*i)->orphaned.load() && (*i)->size() == 0)
+					{
+						i = threads.erase(i);
+						erased = true;
+					}
+					else
+						++i;
+				}
+				// close files no attached buffer has written to, they are
+				// reopened if written again.
+				if (erased)
+				{
+					for (auto i = files.begin(); i != files.end();)
+					{
+						bool used = std::any_of(threads.begin(), threads.end(), [&](auto& buffer) {
+							return std::find(buffer->targets.begin(), buffer->targets.end(),
+								i->first) != buffer->targets.end();
+							});
+						if (used)
+							++i;
+						else
+							i = files.erase(i);
+					}
+				}
+			}
+		}
+
+		void loop()
+		{
+			std::unique_lock<std::mutex> lock(mtxFlush);
+			while (!stopFlush.load())
+			{
+				cvFlush.wait_for(lock, std::chrono::milliseconds(10));
+				unsigned long long target = requested.load();
+				lock.unlock();
+				drain();
+				lock.lock();
+				completed = target;
+				cvFlushed.notify_all();
+			}
+			lock.unlock();
+			drain();
+			files.clear();
+		}
+
+	public:
+
+		std::atomic<debug::log_overflow> policy{ debug::log_overflow::BLOCK };
+		std::atomic<unsigned long long> dropped{ 0 };
+
+		log_backend() : flusher(&log_backend::loop, this) {}
+
+		std::shared_ptr<thread_buffer> attach()
+		{
+			auto ret = std::make_shared<thread_buffer>();
+			std::lock_guard<std::mutex> lock(mtxThreads);
+			threads.push_back(ret);
+			return ret;
+		}
+
+		void wake()
+		{
+			cvFlush.notify_one();
+		}
+
+		// waits till the flusher drains buffer, false if the flusher is
+		// stopping and will not drain it again
+		bool waitSpace(thread_buffer& buffer)
+		{
+			std::unique_lock<std::mutex> lock(mtxSpace);
+			++waitingSpace;
+			// pairs with the fence in drain.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			{
+				std::lock_guard<std::mutex> flushLock(mtxFlush);
+			}
+			cvFlush.notify_one();
+			cvSpace.wait(lock, [&]() {
+				return buffer.size() < thread_buffer::capacity || stopFlush.load();
+				});
+			--waitingSpace;
+			return !stopFlush.load();
+		}
+
+		void flush()
+		{
+			std::unique_lock<std::mutex> lock(mtxFlush);
+			unsigned long long target = ++requested;
+			cvFlush.notify_one();
+			// the flusher exits after a last drain, later records are
+			// written at once.
+			cvFlushed.wait(lock, [&]() { return completed >= target || flushStopped; });
+		}
+
+		~log_backend()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtxFlush);
+				stopFlush = true;
+			}
+			cvFlush.notify_one();
+			{
+				std::lock_guard<std::mutex> lock(mtxSpace);
+			}
+			cvSpace.notify_all();
+			flusher.join();
+			{
+				std::lock_guard<std::mutex> lock(mtxFlush);
+				flushStopped = true;
+			}
+			cvFlushed.notify_all();
+			backend_closed = true;
+		}
+	};
+
+	log_backend& backend()
+	{
+		static log_backend instance;
+		return instance;
+	}
+
+	// the buffer of this thread, left to the flusher on thread exit
+	struct buffer_holder
+	{
+		std::shared_ptr<thread_buffer> buffer;
+
+		~buffer_holder()
+		{
+			if (buffer)
+				buffer->orphaned = true;
+		}
+	};
+
+	thread_local buffer_holder local_buffer;
+}
+
+//queue bytes to be written to target by the flusher
+void write(std::string bytes, const log_target& target)
+{
+	if (backend_closed.load())
+	{
+		write_now(bytes, target);
+		return;
+	}
+	log_backend& flush = backend();
+	if (!local_buffer.buffer)
+		local_buffer.buffer = flush.attach();
+	thread_buffer& local = *local_buffer.buffer;
+	log_record record{ &target, std::move(bytes) };
+	while (!local.push(record))
+	{
+		if (flush.policy.load() == debug::log_overflow::DROP)
+		{
+			++flush.dropped;
+			return;
+		}
+		if (!flush.waitSpace(local))
+		{
+			write_now(record.bytes, target);
+			return;
+		}
+	}
+	if (local.size() >= thread_buffer::capacity / 2)
+		flush.wake();
+}
+
+void debug::setLogOverflow(log_overflow how)
+{
+	backend().policy = how;
+}
+
+unsigned long long debug::getDroppedLogs()
+{
+	return backend().dropped.load();
+}
+
+void debug::flushLog()
+{
+	if (!backend_closed.load())
+		backend().flush();
+}
+
+#else
+
+//write bytes to target
+void write(std::string bytes, const log_target& target)
+{
+	write_now(bytes, target);
+}
+
+void debug::setLogOverflow(log_overflow) {}
+
+unsigned long long debug::getDroppedLogs()
+{
+	return 0;
+}
+
+void debug::flushLog() {}
+
+#endif
+
+namespace
+{
+	// kind of a call site in the binary log, selects the text layout,
+	// debug::log_kind values are the first three
+	enum site_kind : unsigned
+	{
+		SITE_LINE = 0,
+		SITE_DESC = 1,
+		SITE_VALUE = 2,
+		SITE_TEXT = 3
+	};
+
+	struct site_key
+	{
+		unsigned long long file;
+		unsigned long long function;
+		unsigned long long line;
+		unsigned long long var;
+		unsigned kind;
+
+		bool operator==(const site_key& other) const noexcept
+		{
+			return file == other.file && function == other.function && line == other.line
+				&& var == other.var && kind == other.kind;
+		}
+	};
+
+	struct site_hash
+	{
+		std::size_t operator()(const site_key& key) const noexcept
+		{
+			std::size_t ret = key.file;
+			ret = ret * 31 + key.function;
+			ret = ret * 31 + key.line;
+			ret = ret * 31 + key.var;
+			return ret * 31 + key.kind;
+		}
+	};
+
+	// strings and call sites defined in the binary file of this thread
+	struct binary_file
+	{
+		const log_target* target = nullptr;
+		std::chrono::steady_clock::time_point base;
+		std::deque<std::string> strings;
+		std::unordered_map<std::string_view, unsigned long long> string_ids;
+		std::unordered_map<site_key, unsigned long long, site_hash> site_ids;
+		std::unordered_map<const debug::log_site*, unsigned long long> call_ids;
+	};
+
+	// log file of this thread in text format, null till its first log
+	thread_local const log_target* local_text = nullptr;
+
+	thread_local binary_file local_binary;
+
+	void appendString(std::string& out, std::string_view value)
+	{
+		debug::appendVarint(out, value.size());
+		out.append(value.data(), value.size());
+	}
+
+	// id of value in the file of this thread, its definition is appended to
+	// out if new, 0 is no string
+	unsigned long long stringId(std::string& out, std::string_view value)
+	{
+		if (value.empty())
+			return 0;
+		auto pos = local_binary.string_ids.find(value);
+		if (pos != local_binary.string_ids.end())
+			return pos->second;
+		unsigned long long id = local_binary.strings.size() + 1;
+		local_binary.strings.emplace_back(value);
+		local_binary.string_ids.emplace(local_binary.strings.back(), id);
+		out.push_back('S');
+		debug::appendVarint(out, id);
+		appendString(out, value);
+		return id;
+	}
+
+	// id of the call site in the file of this thread, its definition is
+	// appended to out if new
+	unsigned long long siteId(std::string& out, std::string_view file, std::string_view function,
+		unsigned long line, std::string_view var, site_kind kind)
+	{
+		site_key key{ stringId(out, file), stringId(out, function), line, stringId(out, var), kind };
+		auto pos = local_binary.site_ids.find(key);
+		if (pos != local_binary.site_ids.end())
+			return pos->second;
+		unsigned long long id = local_binary.site_ids.size();
+		local_binary.site_ids.emplace(key, id);
+		out.push_back('C');
+		debug::appendVarint(out, id);
+		debug::appendVarint(out, key.file);
+		debug::appendVarint(out, key.function);
+		debug::appendVarint(out, key.line);
+		debug::appendVarint(out, key.var);
+		debug::appendVarint(out, key.kind);
+		return id;
+	}
+
+	// id of the macro call site in the file of this thread, its definition
+	// is appended to out if new
+	unsigned long long siteId(std::string& out, const debug::log_site& site)
+	{
+		auto pos = local_binary.call_ids.find(&site);
+		if (pos != local_binary.call_ids.end())
+			return pos->second;
+		unsigned long long id = siteId(out, site.file, site.function, site.line, site.var,
+			static_cast<site_kind>(site.kind));
+		local_binary.call_ids.emplace(&site, id);
+		return id;
+	}
+}
+
+// the file name of id without extension, setup will indicate if no file
+// existed previously
+std::string fileName(bool& setup, std::thread::id id, const std::string& function)
 {
-	auto file = std::filesystem::path("");
 	std::ostringstream out;
+	out << id << "_thread_fn_" << index().find(setup, id, function);
+	return out.str();
+}
+
+// the text file for id, writes its header if newly registered
+const log_target& registerText(std::thread::id id, const std::string& function)
+{
 	bool setup = false;
-	out << id << "_thread_fn_" << Register(setup, function, id) << ".log";
-	file = out.str();
+	const log_target& file = index().target(fileName(setup, id, function) + ".log", false);
 	if (setup)
 	{
 		std::ostringstream buff;
-		buff << "Thread id : " << id << "\n\t\tthread first logging function " << function;
+		buff << "Thread id : " << id << "\n\t\tthread first logging function " << function << "\n";
 		write(buff.str(), file);
 	}
 	return file;
 }
 
+// the text file of calling thread, looked up once per thread
+const log_target& threadText(std::string_view function)
+{
+	if (!local_text)
+		local_text = &registerText(std::this_thread::get_id(), std::string(function));
+	return *local_text;
+}
+
+// the binary file of calling thread, its header is written on first use
+binary_file& threadBinary(std::string_view function)
+{
+	if (!local_binary.target)
+	{
+		bool setup = false;
+		std::thread::id id = std::this_thread::get_id();
+		local_binary.target = &index().target(fileName(setup, id, std::string(function)) + ".blog",
+			true);
+		local_binary.base = std::chrono::steady_clock::now();
+		std::ostringstream thread;
+		thread << id;
+		std::string header = "H";
+		debug::appendVarint(header, 1);
+		debug::appendVarint(header, std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count());
+		appendString(header, thread.str());
+		appendString(header, function);
+		write(std::move(header), *local_binary.target);
+	}
+	return local_binary;
+}
+
+// logs an event of call site id to the binary file of calling thread, out
+// holds the definitions the event needs
+void logEvent(binary_file& current, std::string& out, unsigned long long site,
+	const std::string* value)
+{
+	out.push_back('E');
+	debug::appendVarint(out, site);
+	debug::appendVarint(out, std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - current.base).count());
+	if (value)
+		out += *value;
+	write(std::move(out), *current.target);
+}
+
+// logs an event of the call site to the binary file of calling thread
+void logBinary(std::string_view file, std::string_view function, unsigned long line,
+	std::string_view var, site_kind kind, const std::string* value)
+{
+	binary_file& current = threadBinary(function);
+	std::string out;
+	unsigned long long site = siteId(out, file, function, line, var, kind);
+	logEvent(current, out, site, value);
+}
+
+// logs an event of the macro call site to the binary file of calling thread
+void logBinary(const debug::log_site& site, const std::string* value)
+{
+	binary_file& current = threadBinary(site.function);
+	std::string out;
+	unsigned long long id = siteId(out, site);
+	logEvent(current, out, id, value);
+}
+
+// the text layout of site up to the value
+void appendSite(std::ostringstream& out, const debug::log_site& site)
+{
+	out << std::setw(80) << site.file << " : " << std::setw(6) << site.line << "   "
+		<< std::setw(15) << site.function;
+}
+
+void debug::setLogFormat(log_format how)
+{
+	format.store(how, std::memory_order_relaxed);
+}
+
+debug::log_format debug::getLogFormat()
+{
+	return format.load(std::memory_order_relaxed);
+}
+
+std::filesystem::path debug::getFile(std::thread::id id, std::string function)
+{
+	if (getLogFormat() == log_format::BINARY)
+	{
+		if (id == std::this_thread::get_id())
+			return threadBinary(function).target->file;
+		bool setup = false;
+		return fileName(setup, id, function) + ".blog";
+	}
+	if (id == std::this_thread::get_id())
+		return threadText(function).file;
+	return registerText(id, function).file;
+}
+
 void debug::Log(std::string lg, std::string function)
 {
-	write(lg, getFile(std::this_thread::get_id(), function));
+	if (getLogFormat() == log_format::BINARY)
+	{
+		logBinary("", function, 0, "", SITE_TEXT, &log_value(lg).encoded());
+		return;
+	}
+	lg.push_back('\n');
+	write(std::move(lg), threadText(function));
 }
 
 void debug::Log(std::string file, std::string function, unsigned long line)
 {
+	if (getLogFormat() == log_format::BINARY)
+	{
+		logBinary(file, function, line, "", SITE_LINE, nullptr);
+		return;
+	}
 	std::ostringstream out;
 	out << std::setw(80) << file << " : " << std::setw(6) << line << "   " << std::setw(15) << function;
 	Log(out.str(), function);
@@ -87,9 +800,101 @@ void debug::Log(std::string file, std::string function, unsigned long line)
 
 void debug::Log(std::string file, std::string function, unsigned long line, std::string descr)
 {
+	if (getLogFormat() == log_format::BINARY)
+	{
+		logBinary(file, function, line, "", SITE_DESC, &log_value(descr).encoded());
+		return;
+	}
 	std::ostringstream out;
 	out << std::setw(80) << file << " : " << std::setw(6) << line << "   " << std::setw(15) << function << " ::   " << descr;
 	Log(out.str(), function);
 }
 
-#endif
\ No newline at end of file
+void debug::LogEncoded(std::string file, std::string function, unsigned long line, std::string var,
+	const log_value& val)
+{
+	logBinary(file, function, line, var, SITE_VALUE, &val.encoded());
+}
+
+bool debug::registerLogSite(const log_site& site, std::atomic<bool>& enabled)
+{
+	site_registry& current = registry();
+	std::lock_guard<std::mutex> lock(current.mtxSites);
+	current.add(site, enabled);
+	return true;
+}
+
+std::vector<const debug::log_site*> debug::getLogSites()
+{
+	site_registry& current = registry();
+	std::lock_guard<std::mutex> lock(current.mtxSites);
+	return current.list();
+}
+
+void debug::setLogOptimisation(unsigned optimisation)
+{
+	site_registry& current = registry();
+	std::lock_guard<std::mutex> lock(current.mtxSites);
+	current.global = optimisation;
+	current.update();
+}
+
+void debug::setLogOptimisation(std::string_view file, unsigned optimisation)
+{
+	site_registry& current = registry();
+	std::lock_guard<std::mutex> lock(current.mtxSites);
+	current.setFile(file, optimisation);
+	current.update();
+}
+
+void debug::setLogOptimisation(std::string_view file, unsigned long line, unsigned optimisation)
+{
+	site_registry& current = registry();
+	std::lock_guard<std::mutex> lock(current.mtxSites);
+	current.setLine(file, line, optimisation);
+	current.update();
+}
+
+void debug::clearLogOptimisation()
+{
+	site_registry& current = registry();
+	std::lock_guard<std::mutex> lock(current.mtxSites);
+	current.clear();
+	current.update();
+}
+
+unsigned debug::getLogOptimisation()
+{
+	return registry().global.load(std::memory_order_relaxed);
+}
+
+void debug::Log(const log_site& site)
+{
+	if (getLogFormat() == log_format::BINARY)
+	{
+		logBinary(site, nullptr);
+		return;
+	}
+	std::ostringstream out;
+	appendSite(out, site);
+	out << "\n";
+	write(out.str(), threadText(site.function));
+}
+
+void debug::LogText(const log_site& site, std::string_view text)
+{
+	std::ostringstream out;
+	appendSite(out, site);
+	if (site.kind == log_kind::DESC)
+		out << " ::   " << text << "\n";
+	else
+		out << "  " << site.var << " = " << text << "\n";
+	write(out.str(), threadText(site.function));
+}
+
+void debug::LogEncoded(const log_site& site, const log_value& val)
+{
+	logBinary(site, &val.encoded());
+}
+
+#endif
@@ -0,0 +1,287 @@
+/** ***************************************************************************
+	\file log_decoder.cpp
+
+	\brief The file for the decoder of binary log files
+
+	Created 17 October 2026
+
+	This file is part of project Enhance C++ Libraries.
+
+	Copyright 2026 Harith Manoj <harithpub@gmail.com>
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+
+
+	<h3> How To Use</h3>
+	- Compile this file alone, it does not need `logger.cpp`.
+
+	- Run `log_decoder [-t] file.blog [file.log]` to write the lines of a
+	file logged with `debug::log_format::BINARY` in the layout of
+	`debug::log_format::TEXT`, to the console if no output file is given.
+
+	- `-t` prefixes each line with the microseconds since the thread first
+	logged.
+
+	<h3> Format </h3>
+	Integers are LEB128 varints, strings a varint length and bytes.
+	- `H` header : version (1), wall clock in ns since epoch, thread id,
+	first logging function. Starts every thread's records.
+	- `S` string : id, string.
+	- `C` call site : id, file string id, function string id, line, variable
+	string id, kind (0 line, 1 description, 2 value, 3 text). String id 0 is
+	empty.
+	- `E` event : call site id, ns since header, value if kind is not line
+	(see debug::log_value).
+
+	A file may hold many headers, ids restart at each.
+
+******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace
+{
+	struct call_site
+	{
+		std::string file;
+		std::string function;
+		unsigned long long line = 0;
+		std::string var;
+		unsigned long long kind = 0;
+	};
+
+	// reads the records of a binary log file, fails on truncated input
+	class decoder
+	{
+		std::istream& in;
+		std::vector<std::string> strings;
+		std::vector<call_site> sites;
+
+		unsigned long long varint()
+		{
+			unsigned long long ret = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7)
+			{
+				int byte = in.get();
+				if (byte == EOF)
+					throw std::runtime_error("truncated varint");
+				ret |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return ret;
+			}
+			throw std::runtime_error("varint too long");
+		}
+
+		std::string string()
+		{
+			std::string ret(varint(), '\0');
+			if (!in.read(ret.data(), ret.size()))
+				throw std::runtime_error("truncated string");
+			return ret;
+		}
+
+		const std::string& stringAt(unsigned long long id)
+		{
+			if (id >= strings.size())
+				throw std::runtime_error("undefined string " + std::to_string(id));
+			return strings[id];
+		}
+
+		// the next byte of a value
+		unsigned char byte()
+		{
+			int ret = in.get();
+			if (ret == EOF)
+				throw std::runtime_error("truncated value");
+			return static_cast<unsigned char>(ret);
+		}
+
+		template<class bits_type>
+		bits_type bits()
+		{
+			bits_type ret = 0;
+			for (std::size_t i = 0; i < sizeof(ret); ++i)
+				ret |= static_cast<bits_type>(byte()) << (8 * i);
+			return ret;
+		}
+
+		void value(std::ostream& out)
+		{
+			switch (byte())
+			{
+			case 'b':
+				out << (byte() != 0);
+				break;
+			case 'c':
+				out << static_cast<char>(byte());
+				break;
+			case 'i':
+			{
+				unsigned long long value = varint();
+				out << ((value & 1) ? static_cast<long long>(~(value >> 1))
+					: static_cast<long long>(value >> 1));
+				break;
+			}
+			case 'u':
+				out << varint();
+				break;
+			case 'f':
+			{
+				std::uint32_t value = bits<std::uint32_t>();
+				float ret;
+				std::memcpy(&ret, &value, sizeof(ret));
+				out << ret;
+				break;
+			}
+			case 'd':
+			{
+				std::uint64_t value = bits<std::uint64_t>();
+				double ret;
+				std::memcpy(&ret, &value, sizeof(ret));
+				out << ret;
+				break;
+			}
+			case 's':
+				out << string();
+				break;
+			default:
+				throw std::runtime_error("unknown value tag");
+			}
+		}
+
+	public:
+
+		bool timestamps = false;
+
+		decoder(std::istream& input) : in(input) {}
+
+		// writes the text layout of all records to out
+		void decode(std::ostream& out)
+		{
+			for (int tag = in.get(); tag != EOF; tag = in.get())
+			{
+				switch (tag)
+				{
+				case 'E':
+				{
+					unsigned long long id = varint();
+					unsigned long long time = varint();
+					if (id >= sites.size())
+						throw std::runtime_error("undefined call site " + std::to_string(id));
+					const call_site& site = sites[id];
+					if (timestamps)
+						out << "[" << std::setw(12) << time / 1000 << "] ";
+					if (site.kind != 3)
+						out << std::setw(80) << site.file << " : " << std::setw(6) << site.line
+						<< "   " << std::setw(15) << site.function;
+					if (site.kind == 1)
+						out << " ::   ";
+					else if (site.kind == 2)
+						out << "  " << site.var << " = ";
+					if (site.kind != 0)
+						value(out);
+					out << "\n";
+					break;
+				}
+				case 'S':
+				{
+					unsigned long long id = varint();
+					if (id != strings.size())
+						throw std::runtime_error("string out of order");
+					strings.push_back(string());
+					break;
+				}
+				case 'C':
+				{
+					call_site site;
+					unsigned long long id = varint();
+					if (id != sites.size())
+						throw std::runtime_error("call site out of order");
+					site.file = stringAt(varint());
+					site.function = stringAt(varint());
+					site.line = varint();
+					site.var = stringAt(varint());
+					site.kind = varint();
+					sites.push_back(std::move(site));
+					break;
+				}
+				case 'H':
+				{
+					if (varint() != 1)
+						throw std::runtime_error("unknown version");
+					varint();
+					strings.assign(1, "");
+					sites.clear();
+					std::string thread = string();
+					out << "Thread id : " << thread << "\n\t\tthread first logging function "
+						<< string() << "\n";
+					break;
+				}
+				default:
+					throw std::runtime_error("unknown record");
+				}
+			}
+		}
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	bool timestamps = false;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string(argv[i]) == "-t")
+			timestamps = true;
+		else
+			files.push_back(argv[i]);
+	}
+	if (files.empty() || files.size() > 2)
+	{
+		std::cerr << "usage : log_decoder [-t] file.blog [file.log]\n";
+		return 2;
+	}
+
+	std::ifstream in(files[0], std::ios::in | std::ios::binary);
+	if (!in)
+	{
+		std::cerr << "cannot open " << files[0] << "\n";
+		return 1;
+	}
+	std::ofstream file;
+	if (files.size() == 2)
+		file.open(files[1]);
+	std::ostream& out = files.size() == 2 ? file : std::cout;
+
+	decoder current(in);
+	current.timestamps = timestamps;
+	try {
+		current.decode(out);
+	}
+	catch (const std::exception& error)
+	{
+		in.clear();
+		std::cerr << files[0] << " : " << error.what() << " at byte " << in.tellg() << "\n";
+		return 1;
+	}
+	return 0;
+}